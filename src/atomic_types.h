@@ -5,4 +5,5 @@
 
 typedef _Atomic bool        atomic_bool_t;
 typedef _Atomic uint32_t    atomic_uint32_t;
-typedef _Atomic int32_t     atomic_int32_t;
\ No newline at end of file
+typedef _Atomic int32_t     atomic_int32_t;
+typedef _Atomic uint64_t    atomic_uint64_t;
\ No newline at end of file
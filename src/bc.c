@@ -0,0 +1,354 @@
+#include "bc.h"
+
+#include <math.h>
+#include <string.h>
+
+/********************
+ *  Notes
+ *
+ * - Block compression formats  - https://learn.microsoft.com/en-us/windows/win32/direct3d10/d3d10-graphics-programming-guide-resources-block-compression
+ * - Real-time DXT compression  - https://www.researchgate.net/publication/259000525_Real-Time_DXT_Compression
+ *
+ * Every block covers 4x4 texels, texel i is at x = i % 4, y = i / 4. The BC1 encoder fits a line through the
+ * block colors along their principal axis and quantizes the extremes to 565 endpoints, BC4 uses the minimum and
+ * maximum value as endpoints in the 8 value mode. Both pick the closest palette entry per texel. Encoder and
+ * decoder build the palette with the same integer rounding so a decoded block matches what the encoder measured.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define POWER_ITERATIONS 4
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static uint16_t pack_565(const float c[3])
+{
+    uint32_t r = (uint32_t)(c[0] * 31.f / 255.f + 0.5f);
+    uint32_t g = (uint32_t)(c[1] * 63.f / 255.f + 0.5f);
+    uint32_t b = (uint32_t)(c[2] * 31.f / 255.f + 0.5f);
+
+    return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+static void unpack_565(uint16_t c, unsigned char rgb[3])
+{
+    uint32_t r  = (c >> 11) & 31;
+    uint32_t g  = (c >> 5) & 63;
+    uint32_t b  = c & 31;
+
+    // bit replication maps 31 and 63 to 255
+    rgb[0]      = (unsigned char)(r << 3 | r >> 2);
+    rgb[1]      = (unsigned char)(g << 2 | g >> 4);
+    rgb[2]      = (unsigned char)(b << 3 | b >> 2);
+}
+
+static void bc1_palette(uint16_t c0, uint16_t c1, unsigned char palette[4][3])
+{
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        uint32_t a  = palette[0][c];
+        uint32_t b  = palette[1][c];
+
+        if (c0 > c1)
+        {
+            palette[2][c] = (unsigned char)((2 * a + b + 1) / 3);
+            palette[3][c] = (unsigned char)((a + 2 * b + 1) / 3);
+        }
+        else
+        {
+            // 3 color mode, the fourth entry is black
+            palette[2][c] = (unsigned char)((a + b + 1) / 2);
+            palette[3][c] = 0;
+        }
+    }
+}
+
+static void bc4_palette(uint32_t a0, uint32_t a1, unsigned char palette[8])
+{
+    palette[0] = (unsigned char)a0;
+    palette[1] = (unsigned char)a1;
+
+    if (a0 > a1)
+    {
+        for (uint32_t i = 2; i < 8; i++)
+        {
+            palette[i] = (unsigned char)(((8 - i) * a0 + (i - 1) * a1 + 3) / 7);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 2; i < 6; i++)
+        {
+            palette[i] = (unsigned char)(((6 - i) * a0 + (i - 1) * a1 + 2) / 5);
+        }
+
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+/********************/
+/* public functions */
+/********************/
+
+void bc1_encode(const unsigned char rgb[BC_BLOCK_TEXELS * 3], unsigned char* block)
+{
+    // principal axis of the block colors
+    float mean[3]   = { 0.f, 0.f, 0.f };
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            mean[c] += (float)rgb[i * 3 + c] / (float)BC_BLOCK_TEXELS;
+        }
+    }
+
+    float cov[6]    = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        float r     = (float)rgb[i * 3 + 0] - mean[0];
+        float g     = (float)rgb[i * 3 + 1] - mean[1];
+        float b     = (float)rgb[i * 3 + 2] - mean[2];
+
+        cov[0]     += r * r;
+        cov[1]     += r * g;
+        cov[2]     += r * b;
+        cov[3]     += g * g;
+        cov[4]     += g * b;
+        cov[5]     += b * b;
+    }
+
+    // start from the covariance column of the widest channel, a fixed start vector can be orthogonal to the axis
+    float axis[3]   = { cov[0], cov[1], cov[2] };
+
+    if (cov[3] > cov[0] && cov[3] >= cov[5])
+    {
+        axis[0]     = cov[1];
+        axis[1]     = cov[3];
+        axis[2]     = cov[4];
+    }
+    else if (cov[5] > cov[0] && cov[5] > cov[3])
+    {
+        axis[0]     = cov[2];
+        axis[1]     = cov[4];
+        axis[2]     = cov[5];
+    }
+
+    for (uint32_t i = 0; i < POWER_ITERATIONS; i++)
+    {
+        float x     = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y     = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z     = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len   = fmaxf(fmaxf(fabsf(x), fabsf(y)), fabsf(z));
+
+        if (len == 0.f)
+        {
+            break;
+        }
+
+        axis[0]     = x / len;
+        axis[1]     = y / len;
+        axis[2]     = z / len;
+    }
+
+    // extremes along the axis become the endpoints
+    float t_min     = INFINITY;
+    float t_max     = -INFINITY;
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        float t     = 0.f;
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            t      += ((float)rgb[i * 3 + c] - mean[c]) * axis[c];
+        }
+
+        t_min       = fminf(t_min, t);
+        t_max       = fmaxf(t_max, t);
+    }
+
+    // flat blocks have no axis
+    float len_sq    = fmaxf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2], 1e-12f);
+    float e0[3];
+    float e1[3];
+
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        e0[c]       = fminf(fmaxf(mean[c] + axis[c] * t_max / len_sq, 0.f), 255.f);
+        e1[c]       = fminf(fmaxf(mean[c] + axis[c] * t_min / len_sq, 0.f), 255.f);
+    }
+
+    uint16_t c0     = pack_565(e0);
+    uint16_t c1     = pack_565(e1);
+
+    // 4 color mode needs c0 > c1
+    if (c0 < c1)
+    {
+        uint16_t temp = c0;
+        c0          = c1;
+        c1          = temp;
+    }
+
+    unsigned char palette[4][3];
+    bc1_palette(c0, c1, palette);
+
+    uint32_t indices = 0;
+
+    // equal endpoints leave every index at 0
+    for (uint32_t i = 0; c0 != c1 && i < BC_BLOCK_TEXELS; i++)
+    {
+        uint32_t best       = 0;
+        int32_t best_dist   = INT32_MAX;
+
+        for (uint32_t p = 0; p < 4; p++)
+        {
+            int32_t dist    = 0;
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                int32_t d   = (int32_t)rgb[i * 3 + c] - (int32_t)palette[p][c];
+                dist       += d * d;
+            }
+
+            if (dist < best_dist)
+            {
+                best        = p;
+                best_dist   = dist;
+            }
+        }
+
+        indices            |= best << (2 * i);
+    }
+
+    block[0]        = (unsigned char)(c0 & 0xFF);
+    block[1]        = (unsigned char)(c0 >> 8);
+    block[2]        = (unsigned char)(c1 & 0xFF);
+    block[3]        = (unsigned char)(c1 >> 8);
+    memcpy(&block[4], &indices, 4);
+}
+
+void bc1_decode(const unsigned char* block, unsigned char rgb[BC_BLOCK_TEXELS * 3])
+{
+    uint16_t c0     = (uint16_t)(block[0] | block[1] << 8);
+    uint16_t c1     = (uint16_t)(block[2] | block[3] << 8);
+    uint32_t indices;
+    memcpy(&indices, &block[4], 4);
+
+    unsigned char palette[4][3];
+    bc1_palette(c0, c1, palette);
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        const unsigned char* entry = palette[(indices >> (2 * i)) & 3];
+
+        rgb[i * 3 + 0] = entry[0];
+        rgb[i * 3 + 1] = entry[1];
+        rgb[i * 3 + 2] = entry[2];
+    }
+}
+
+void bc4_encode(const unsigned char values[BC_BLOCK_TEXELS], unsigned char* block)
+{
+    uint32_t a0     = 0;
+    uint32_t a1     = 255;
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        a0          = values[i] > a0 ? values[i] : a0;
+        a1          = values[i] < a1 ? values[i] : a1;
+    }
+
+    unsigned char palette[8];
+    bc4_palette(a0, a1, palette);
+
+    uint64_t indices = 0;
+
+    for (uint32_t i = 0; a0 != a1 && i < BC_BLOCK_TEXELS; i++)
+    {
+        uint64_t best       = 0;
+        int32_t best_dist   = INT32_MAX;
+
+        for (uint32_t p = 0; p < 8; p++)
+        {
+            int32_t d       = (int32_t)values[i] - (int32_t)palette[p];
+
+            if (d * d < best_dist)
+            {
+                best        = p;
+                best_dist   = d * d;
+            }
+        }
+
+        indices            |= best << (3 * i);
+    }
+
+    block[0]        = (unsigned char)a0;
+    block[1]        = (unsigned char)a1;
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        block[2 + i] = (unsigned char)(indices >> (8 * i));
+    }
+}
+
+void bc4_decode(const unsigned char* block, unsigned char values[BC_BLOCK_TEXELS])
+{
+    unsigned char palette[8];
+    bc4_palette(block[0], block[1], palette);
+
+    uint64_t indices = 0;
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        indices    |= (uint64_t)block[2 + i] << (8 * i);
+    }
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        values[i]   = palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+void bc5_encode(const unsigned char rg[BC_BLOCK_TEXELS * 2], unsigned char* block)
+{
+    unsigned char r[BC_BLOCK_TEXELS];
+    unsigned char g[BC_BLOCK_TEXELS];
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        r[i]        = rg[i * 2 + 0];
+        g[i]        = rg[i * 2 + 1];
+    }
+
+    bc4_encode(r, block);
+    bc4_encode(g, block + BC4_BLOCK_BYTES);
+}
+
+void bc5_decode(const unsigned char* block, unsigned char rg[BC_BLOCK_TEXELS * 2])
+{
+    unsigned char r[BC_BLOCK_TEXELS];
+    unsigned char g[BC_BLOCK_TEXELS];
+
+    bc4_decode(block, r);
+    bc4_decode(block + BC4_BLOCK_BYTES, g);
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        rg[i * 2 + 0] = r[i];
+        rg[i * 2 + 1] = g[i];
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+#define BC_BLOCK_SIZE       4               // texels per block side
+#define BC_BLOCK_TEXELS     16
+#define BC1_BLOCK_BYTES     8               // rgb, 4 bits per texel
+#define BC4_BLOCK_BYTES     8               // one channel, 4 bits per texel
+#define BC5_BLOCK_BYTES     16              // two BC4 blocks, 8 bits per texel
+
+// texels are interleaved, rgb rgb .. and rg rg ..
+
+void bc1_encode(const unsigned char rgb[BC_BLOCK_TEXELS * 3], unsigned char* block);
+void bc1_decode(const unsigned char* block, unsigned char rgb[BC_BLOCK_TEXELS * 3]);
+void bc4_encode(const unsigned char values[BC_BLOCK_TEXELS], unsigned char* block);
+void bc4_decode(const unsigned char* block, unsigned char values[BC_BLOCK_TEXELS]);
+void bc5_encode(const unsigned char rg[BC_BLOCK_TEXELS * 2], unsigned char* block);
+void bc5_decode(const unsigned char* block, unsigned char rg[BC_BLOCK_TEXELS * 2]);
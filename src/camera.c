@@ -177,6 +177,14 @@ void camera_update(camera_t* cam, input_t input)
     camera_generate_basis(cam);
 }
 
+void camera_set_aspect_ratio(camera_t* cam, float aspect_ratio)
+{
+    // the horizontal field of view is kept, the vertical one follows the window
+    cam->asp_ratio      = aspect_ratio;
+    cam->t_dist         = cam->r_dist / aspect_ratio;
+    cam->b_dist         = -cam->t_dist;
+}
+
 mat_t camera_view_mat(camera_t* cam)
 {
     mat_t result        = mat_new_identity();
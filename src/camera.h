@@ -3,7 +3,7 @@
 #include <stdbool.h>
 
 #include "math.h"
-#include "linux/input.h"
+#include "input.h"
 
 typedef struct
 {
@@ -36,6 +36,7 @@ camera_t*   camera_new(vec4_t target,
                        float far,
                        float aspect_ratio);
 void        camera_update(camera_t* cam, input_t input);
+void        camera_set_aspect_ratio(camera_t* cam, float aspect_ratio);
 mat_t       camera_view_mat(camera_t* cam);
 mat_t       camera_proj_mat(camera_t* cam);
 void        camera_free(camera_t* cam);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
 
+// initial window size, see set_window_size
 #define WINDOW_WIDTH   800
 #define WINDOW_HEIGHT  600
\ No newline at end of file
@@ -1,17 +1,29 @@
 #include "depthbuffer.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 /********************
  *  Notes
  *
+ * Cleared lazily like the framebuffer, clearing flags the tiles and the first write to a tile fills it.
+ *
+ * Depth is reversed, the projection maps the near plane to 1 and the far plane to 0 and the larger value wins.
+ * Floats are densest near 0, so the far range gets the precision lost to the perspective divide. Unorm formats
+ * quantize once per pixel and depthbuffer_test compares in the stored format, U16 halves the bytes a depth test
+ * touches and is used for shadow maps, where depth is linear.
  ********************/
 
 /********************/
 /*      defines     */
 /********************/
 
+#define TILE_MASK   (FRAMEBUFFER_TILE_SIZE - 1)
+#define TILE_PIXELS (FRAMEBUFFER_TILE_SIZE * FRAMEBUFFER_TILE_SIZE)
+#define U24_MAX     0xFFFFFF
+#define U16_MAX     0xFFFF
+
 /********************/
 /* static variables */
 /********************/
@@ -20,6 +32,109 @@
 /* static functions */
 /********************/
 
+static inline uint32_t tile_index(const depthbuffer_t* buffer, uint32_t x, uint32_t y)
+{
+    return (y >> FRAMEBUFFER_TILE_SHIFT) * buffer->tiles_x + (x >> FRAMEBUFFER_TILE_SHIFT);
+}
+
+static inline uint32_t pixel_index(const depthbuffer_t* buffer, uint32_t x, uint32_t y)
+{
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_TILED)
+    {
+        return tile_index(buffer, x, y) * TILE_PIXELS + ((y & TILE_MASK) << FRAMEBUFFER_TILE_SHIFT) + (x & TILE_MASK);
+    }
+
+    return y * buffer->width + x;
+}
+
+static uint32_t data_size(const depthbuffer_t* buffer)
+{
+    // tiled buffers are padded to whole tiles
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_TILED)
+    {
+        return buffer->tiles_x * buffer->tiles_y * TILE_PIXELS;
+    }
+
+    return buffer->width * buffer->height;
+}
+
+static uint32_t element_size(depth_format_e format)
+{
+    return format == DEPTH_FORMAT_U16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+static inline uint32_t quantize(float val, uint32_t max)
+{
+    float clamped = val < 0.f ? 0.f : (val > 1.f ? 1.f : val);
+    return (uint32_t)(clamped * (float)max + 0.5f);
+}
+
+static inline float load(const depthbuffer_t* buffer, uint32_t index)
+{
+    switch (buffer->format)
+    {
+        case DEPTH_FORMAT_U24:
+            return (float)buffer->data_u24[index] * (1.f / (float)U24_MAX);
+        case DEPTH_FORMAT_U16:
+            return (float)buffer->data_u16[index] * (1.f / (float)U16_MAX);
+        default:
+            return buffer->data[index];
+    }
+}
+
+static inline void store(depthbuffer_t* buffer, uint32_t index, float val)
+{
+    switch (buffer->format)
+    {
+        case DEPTH_FORMAT_U24:
+            buffer->data_u24[index] = quantize(val, U24_MAX);
+            break;
+        case DEPTH_FORMAT_U16:
+            buffer->data_u16[index] = (uint16_t)quantize(val, U16_MAX);
+            break;
+        default:
+            buffer->data[index] = val;
+            break;
+    }
+}
+
+static void fill_tile(depthbuffer_t* buffer, uint32_t tile)
+{
+    uint32_t x0 = (tile % buffer->tiles_x) << FRAMEBUFFER_TILE_SHIFT;
+    uint32_t y0 = (tile / buffer->tiles_x) << FRAMEBUFFER_TILE_SHIFT;
+    uint32_t x1 = x0 + FRAMEBUFFER_TILE_SIZE < buffer->width ? x0 + FRAMEBUFFER_TILE_SIZE : buffer->width;
+    uint32_t y1 = y0 + FRAMEBUFFER_TILE_SIZE < buffer->height ? y0 + FRAMEBUFFER_TILE_SIZE : buffer->height;
+    uint32_t size = element_size(buffer->format);
+
+    // 0 in every format
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        memset((unsigned char*)buffer->data + pixel_index(buffer, x0, y) * size, 0, (x1 - x0) * size);
+    }
+
+    buffer->cleared[tile] = false;
+}
+
+static void convert(depthbuffer_t* buffer, framebuffer_layout_e layout, depth_format_e format)
+{
+    // tiles are numbered the same in both layouts, cleared tiles stay cleared
+    depthbuffer_t source = *buffer;
+
+    buffer->layout = layout;
+    buffer->format = format;
+    buffer->data = malloc(data_size(buffer) * element_size(format));
+
+    for (uint32_t y = 0; y < buffer->height; y++)
+    {
+        for (uint32_t x = 0; x < buffer->width; x++)
+        {
+            store(buffer, pixel_index(buffer, x, y), load(&source, pixel_index(&source, x, y)));
+        }
+    }
+
+    free(source.data);
+}
+
 /********************/
 /* public functions */
 /********************/
@@ -31,57 +146,117 @@ depthbuffer_t* depthbuffer_new(uint32_t width, uint32_t height)
     depthbuffer_t* buffer = malloc(sizeof(depthbuffer_t));
     buffer->width = width;
     buffer->height = height;
-    buffer->origin = width * height - width;
+    buffer->tiles_x = (width + TILE_MASK) >> FRAMEBUFFER_TILE_SHIFT;
+    buffer->tiles_y = (height + TILE_MASK) >> FRAMEBUFFER_TILE_SHIFT;
+    buffer->layout = FRAMEBUFFER_LAYOUT_LINEAR;
+    buffer->format = DEPTH_FORMAT_F32;
     buffer->data = malloc(width * height * sizeof(float));
+    buffer->cleared = malloc(buffer->tiles_x * buffer->tiles_y * sizeof(bool));
 
     depthbuffer_clear(buffer);
 
     return buffer;
 }
 
+void depthbuffer_set_layout(depthbuffer_t* buffer, framebuffer_layout_e layout)
+{
+    if (buffer->layout != layout)
+    {
+        convert(buffer, layout, buffer->format);
+    }
+}
+
+void depthbuffer_set_format(depthbuffer_t* buffer, depth_format_e format)
+{
+    assert(format < DEPTH_FORMAT_SIZE);
+
+    if (buffer->format != format)
+    {
+        convert(buffer, buffer->layout, format);
+    }
+}
+
 void depthbuffer_set(depthbuffer_t* buffer, uint32_t x, uint32_t y, float val)
 {
-    uint32_t index = buffer->origin - y * buffer->width + x;
-    buffer->data[index] = val;
+    uint32_t tile = tile_index(buffer, x, y);
+
+    if (buffer->cleared[tile])
+    {
+        fill_tile(buffer, tile);
+    }
+
+    store(buffer, pixel_index(buffer, x, y), val);
 }
 
 float depthbuffer_get(depthbuffer_t* buffer, uint32_t x, uint32_t y)
 {
-    uint32_t index = buffer->origin - y * buffer->width + x;
-    return buffer->data[index];
+    if (buffer->cleared[tile_index(buffer, x, y)])
+    {
+        return 0.f;
+    }
+
+    return load(buffer, pixel_index(buffer, x, y));
 }
 
-void depthbuffer_clear(depthbuffer_t* buffer)
+bool depthbuffer_test(depthbuffer_t* buffer, uint32_t x, uint32_t y, float val)
 {
-    uint32_t i      = 0;
-    float* data     = buffer->data;
-    uint32_t size   = buffer->width * buffer->height;
+    // stores val if it is at least as near as the stored depth, compared after quantizing
+    uint32_t tile = tile_index(buffer, x, y);
 
-    // clear up to size - 7
-    while (i + 8 < size)
+    if (buffer->cleared[tile])
     {
-        data[i + 0] = 0.f;
-        data[i + 1] = 0.f;
-        data[i + 2] = 0.f;
-        data[i + 3] = 0.f;
-        data[i + 4] = 0.f;
-        data[i + 5] = 0.f;
-        data[i + 6] = 0.f;
-        data[i + 7] = 0.f;
-
-        i += 8;
+        fill_tile(buffer, tile);
     }
 
-    // clear the rest
-    while (i < size)
+    uint32_t index = pixel_index(buffer, x, y);
+
+    switch (buffer->format)
     {
-        data[i] = 0.f;
-        i++;
+        case DEPTH_FORMAT_U24:
+        {
+            uint32_t q = quantize(val, U24_MAX);
+
+            if (q < buffer->data_u24[index])
+            {
+                return false;
+            }
+
+            buffer->data_u24[index] = q;
+            return true;
+        }
+        case DEPTH_FORMAT_U16:
+        {
+            uint16_t q = (uint16_t)quantize(val, U16_MAX);
+
+            if (q < buffer->data_u16[index])
+            {
+                return false;
+            }
+
+            buffer->data_u16[index] = q;
+            return true;
+        }
+        default:
+        {
+            if (val < buffer->data[index])
+            {
+                return false;
+            }
+
+            buffer->data[index] = val;
+            return true;
+        }
     }
 }
 
+void depthbuffer_clear(depthbuffer_t* buffer)
+{
+    memset(buffer->cleared, 1, buffer->tiles_x * buffer->tiles_y * sizeof(bool));
+}
+
 void depthbuffer_free(depthbuffer_t* buffer)
 {
+    free(buffer->cleared);
     free(buffer->data);
     free(buffer);
 }
\ No newline at end of file
@@ -1,18 +1,41 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#include "framebuffer.h"
+
+typedef enum
+{
+    DEPTH_FORMAT_F32 = 0,   /* float, reversed z keeps the precision of the exponent for distant surfaces */
+    DEPTH_FORMAT_U24,       /* unorm in the low 24 bits of a word */
+    DEPTH_FORMAT_U16,       /* unorm, half the bytes, enough for shadow maps */
+    DEPTH_FORMAT_SIZE
+} depth_format_e;
 
 typedef struct
 {
-    uint32_t width;
-    uint32_t height;
-    uint32_t origin;
-    float*   data;
+    uint32_t                width;
+    uint32_t                height;
+    uint32_t                tiles_x;
+    uint32_t                tiles_y;
+    framebuffer_layout_e    layout;     // same tiles as the framebuffer
+    depth_format_e          format;     // 1 is the near plane, 0 the far plane and the clear value
+    union
+    {
+        float*              data;       // DEPTH_FORMAT_F32
+        uint32_t*           data_u24;   // DEPTH_FORMAT_U24
+        uint16_t*           data_u16;   // DEPTH_FORMAT_U16
+    };
+    bool*                   cleared;    // per tile, not written since the last clear, reads return 0
 
 } depthbuffer_t;
 
 depthbuffer_t*  depthbuffer_new(uint32_t width, uint32_t height);
+void            depthbuffer_set_layout(depthbuffer_t* buffer, framebuffer_layout_e layout);
+void            depthbuffer_set_format(depthbuffer_t* buffer, depth_format_e format);
 void            depthbuffer_set(depthbuffer_t* buffer, uint32_t x, uint32_t y, float val);
 float           depthbuffer_get(depthbuffer_t* buffer, uint32_t x, uint32_t y);
+bool            depthbuffer_test(depthbuffer_t* buffer, uint32_t x, uint32_t y, float val);
 void            depthbuffer_clear(depthbuffer_t* buffer);
-void            depthbuffer_free(depthbuffer_t* buffer);
+void            depthbuffer_free(depthbuffer_t* buffer);
\ No newline at end of file
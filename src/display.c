@@ -0,0 +1,102 @@
+#include "display.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "headless.h"
+
+#if !defined(HEADLESS)
+#include "linux/x11.h"
+#endif
+
+/********************
+ *  Notes
+ *
+ * The display shows the rendered frames and reports the input. Each backend sets up the images and its table of
+ * functions in its init, the calls below go through the table. The X11 backend lives in linux/, builds made with
+ * HEADLESS=1 leave it out together with the X libraries and only the headless backend is available.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+/********************/
+/* public functions */
+/********************/
+
+display_t* display_new(display_backend_e backend, uint32_t width, uint32_t height)
+{
+    display_t* dsp = calloc(1, sizeof(display_t));
+
+    switch (backend)
+    {
+        case DISPLAY_BACKEND_HEADLESS:
+            headless_init(dsp, width, height);
+            break;
+#if !defined(HEADLESS)
+        case DISPLAY_BACKEND_X11:
+            x11_init(dsp, width, height);
+            break;
+#endif
+        default:
+            printf("display backend %d is not part of this build\n", backend);
+            assert(false);
+            break;
+    }
+
+    return dsp;
+}
+
+void display_resize(display_t* dsp, uint32_t width, uint32_t height)
+{
+    if (width == dsp->width && height == dsp->height)
+    {
+        return;
+    }
+
+    dsp->backend->resize(dsp, width, height);
+}
+
+framebuffer_t* display_framebuffer(display_t* dsp, uint32_t index)
+{
+    assert(index < DISPLAY_BUFFERS);
+
+    return dsp->framebuffers[index];
+}
+
+void display_wait(display_t* dsp, const framebuffer_t* framebuffer)
+{
+    dsp->backend->wait(dsp, framebuffer);
+}
+
+void display_draw(display_t* dsp, const framebuffer_t* framebuffer)
+{
+    dsp->backend->draw(dsp, framebuffer);
+}
+
+void display_clear(display_t* dsp)
+{
+    dsp->backend->clear(dsp);
+}
+
+input_t display_input(display_t* dsp)
+{
+    return dsp->backend->input(dsp);
+}
+
+void display_free(display_t* dsp)
+{
+    dsp->backend->free(dsp);
+    free(dsp);
+}
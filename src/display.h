@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+#include "input.h"
+
+#define DISPLAY_BUFFERS 3               // enough for triple buffering
+
+typedef enum
+{
+    DISPLAY_BACKEND_X11 = 0,            /* window on an X server, see linux/x11_display.c */
+    DISPLAY_BACKEND_HEADLESS            /* no window, scripted input, see headless.c */
+} display_backend_e;
+
+typedef struct display
+{
+    const struct display_backend* backend;
+    uint32_t        width;              // size of the images, follows the window
+    uint32_t        height;
+    framebuffer_t*  framebuffers[DISPLAY_BUFFERS];  // set by the backend, frames are rendered straight into them
+    void*           data;               // backend state
+
+} display_t;
+
+typedef struct display_backend
+{
+    void            (*resize)(display_t* dsp, uint32_t width, uint32_t height);
+    void            (*wait)(display_t* dsp, const framebuffer_t* framebuffer);
+    void            (*draw)(display_t* dsp, const framebuffer_t* framebuffer);
+    void            (*clear)(display_t* dsp);
+    input_t         (*input)(display_t* dsp);
+    void            (*free)(display_t* dsp);
+
+} display_backend_t;
+
+display_t*      display_new(display_backend_e backend, uint32_t width, uint32_t height);
+void            display_resize(display_t* dsp, uint32_t width, uint32_t height);
+framebuffer_t*  display_framebuffer(display_t* dsp, uint32_t index);
+void            display_wait(display_t* dsp, const framebuffer_t* framebuffer);
+void            display_draw(display_t* dsp, const framebuffer_t* framebuffer);
+void            display_clear(display_t* dsp);
+input_t         display_input(display_t* dsp);
+void            display_free(display_t* dsp);
@@ -0,0 +1,85 @@
+#include "frame_queue.h"
+
+#include <stdlib.h>
+
+/********************
+ *  Notes
+ *
+ * Single producer, single consumer ring. Each index is written by one side only, the release store that
+ * publishes it pairs with the acquire load on the other side so the slot contents are visible before the index.
+ * Indices run freely and wrap with the mask, tail - head is the number of queued frames.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define FRAME_QUEUE_MASK (FRAME_QUEUE_SIZE - 1)
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+/********************/
+/* public functions */
+/********************/
+
+frame_queue_t* frame_queue_new()
+{
+    frame_queue_t* queue = calloc(1, sizeof(frame_queue_t));
+
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+
+    return queue;
+}
+
+bool frame_queue_push(frame_queue_t* queue, frame_t frame)
+{
+    uint32_t tail   = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint32_t head   = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if (tail - head == FRAME_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    queue->slots[tail & FRAME_QUEUE_MASK] = frame;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+bool frame_queue_pop(frame_queue_t* queue, frame_t* frame)
+{
+    uint32_t head   = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint32_t tail   = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    *frame          = queue->slots[head & FRAME_QUEUE_MASK];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+uint32_t frame_queue_size(frame_queue_t* queue)
+{
+    // exact only while neither side is active
+    uint32_t head   = atomic_load_explicit(&queue->head, memory_order_acquire);
+    uint32_t tail   = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    return tail - head;
+}
+
+void frame_queue_free(frame_queue_t* queue)
+{
+    free(queue);
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "atomic_types.h"
+#include "framebuffer.h"
+#include "time_utils.h"
+
+#define FRAME_QUEUE_SIZE 4      // power of two, larger than the frames in flight
+
+typedef struct
+{
+    framebuffer_t*  framebuffer;
+    timestamp_t     submitted;
+
+} frame_t;
+
+// one producer and one consumer thread
+typedef struct
+{
+    frame_t         slots[FRAME_QUEUE_SIZE];
+    atomic_uint32_t head;       // next slot to pop, written by the consumer
+    atomic_uint32_t tail;       // next slot to push, written by the producer
+
+} frame_queue_t;
+
+frame_queue_t*  frame_queue_new();
+bool            frame_queue_push(frame_queue_t* queue, frame_t frame);
+bool            frame_queue_pop(frame_queue_t* queue, frame_t* frame);
+uint32_t        frame_queue_size(frame_queue_t* queue);
+void            frame_queue_free(frame_queue_t* queue);
\ No newline at end of file
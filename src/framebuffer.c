@@ -4,17 +4,35 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "rasterizer_constants.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /********************
  *  Notes
  *
+ * The tiled layout keeps every 8x8 block of pixels contiguous, a block is 4 cache lines. Work split in tiles
+ * touches few lines and never shares one with a neighbouring tile. Tiled framebuffers are always owned, the
+ * display shows linear images, framebuffer_detile converts right before presenting.
+ *
+ * Clearing only flags the tiles, in either layout. Reads of a flagged tile return the clear colour, the first
+ * write fills the tile and drops the flag. Tiles nothing was drawn to are filled when the frame is presented,
+ * by framebuffer_detile or framebuffer_resolve_clear.
+ *
+ * Frames rendered below the window size are upscaled bilinearly while presenting. Pixel centres are mapped onto
+ * each other and the weights are 8 bit fixed point, the same size upscales to an exact copy. A pixel's offset is
+ * the sum of a row and a column part in both layouts, so the source positions of every target row and column are
+ * computed once per size (framebuffer_upscale_table_new) and the loop only gathers 4 pixels and blends them, 4
+ * channels at a time with SSE2.
  ********************/
 
 /********************/
 /*      defines     */
 /********************/
 
+#define TILE_MASK   (FRAMEBUFFER_TILE_SIZE - 1)
+#define TILE_PIXELS (FRAMEBUFFER_TILE_SIZE * FRAMEBUFFER_TILE_SIZE)
+
 /********************/
 /* static variables */
 /********************/
@@ -23,6 +41,144 @@
 /* static functions */
 /********************/
 
+static inline uint32_t tile_index(const framebuffer_t* buffer, uint32_t x, uint32_t y)
+{
+    return (y >> FRAMEBUFFER_TILE_SHIFT) * buffer->tiles_x + (x >> FRAMEBUFFER_TILE_SHIFT);
+}
+
+static inline uint32_t pixel_index(const framebuffer_t* buffer, uint32_t x, uint32_t y)
+{
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_TILED)
+    {
+        return tile_index(buffer, x, y) * TILE_PIXELS + ((y & TILE_MASK) << FRAMEBUFFER_TILE_SHIFT) + (x & TILE_MASK);
+    }
+
+    return y * buffer->pitch + x;
+}
+
+static inline uint32_t row_offset(const framebuffer_t* buffer, uint32_t y)
+{
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_TILED)
+    {
+        return (y >> FRAMEBUFFER_TILE_SHIFT) * buffer->tiles_x * TILE_PIXELS + ((y & TILE_MASK) << FRAMEBUFFER_TILE_SHIFT);
+    }
+
+    return y * buffer->pitch;
+}
+
+static inline uint32_t column_offset(const framebuffer_t* buffer, uint32_t x)
+{
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_TILED)
+    {
+        return (x >> FRAMEBUFFER_TILE_SHIFT) * TILE_PIXELS + (x & TILE_MASK);
+    }
+
+    return x;
+}
+
+static void upscale_axis(uint32_t source_size, uint32_t target_size, uint32_t* first, uint32_t* weight)
+{
+    // centre of target pixel i at (i + 0.5) * source_size / target_size - 0.5 source pixels, 1/256 units
+    for (uint32_t i = 0; i < target_size; i++)
+    {
+        int64_t position = (int64_t)(2 * i + 1) * source_size * 128 / target_size - 128;
+        position = position < 0 ? 0 : position;
+
+        first[i] = (uint32_t)(position >> 8);
+        weight[i] = (uint32_t)(position & 255);
+
+        // the edge pixel is repeated past the last centre
+        if (first[i] >= source_size - 1)
+        {
+            first[i] = source_size - 1;
+            weight[i] = 0;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+
+static inline uint32_t bilerp(uint32_t t0, uint32_t t1, uint32_t b0, uint32_t b1, uint32_t wx, uint32_t wy)
+{
+    // 8 bit weights, 255 * 256 + 128 still fits 16 bits
+    __m128i zero    = _mm_setzero_si128();
+    __m128i round   = _mm_set1_epi16(128);
+    __m128i texels  = _mm_set_epi32((int32_t)b1, (int32_t)b0, (int32_t)t1, (int32_t)t0);
+    __m128i top     = _mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), _mm_set1_epi16((int16_t)(256 - wy)));
+    __m128i bottom  = _mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), _mm_set1_epi16((int16_t)wy));
+    __m128i v       = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(top, bottom), round), 8);
+
+    // left pixel in the low half, right one in the high half
+    v               = _mm_mullo_epi16(v, _mm_set_epi16((int16_t)wx, (int16_t)wx, (int16_t)wx, (int16_t)wx,
+                                                       (int16_t)(256 - wx), (int16_t)(256 - wx),
+                                                       (int16_t)(256 - wx), (int16_t)(256 - wx)));
+    v               = _mm_add_epi16(v, _mm_srli_si128(v, 8));
+    v               = _mm_srli_epi16(_mm_add_epi16(v, round), 8);
+
+    return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+}
+
+#else
+
+static inline uint32_t bilerp(uint32_t t0, uint32_t t1, uint32_t b0, uint32_t b1, uint32_t wx, uint32_t wy)
+{
+    // same rounding as the SSE2 version
+    uint32_t result = 0;
+
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        uint32_t left   = (((t0 >> shift) & 255) * (256 - wy) + ((b0 >> shift) & 255) * wy + 128) >> 8;
+        uint32_t right  = (((t1 >> shift) & 255) * (256 - wy) + ((b1 >> shift) & 255) * wy + 128) >> 8;
+
+        result         |= ((left * (256 - wx) + right * wx + 128) >> 8) << shift;
+    }
+
+    return result;
+}
+
+#endif
+
+static uint32_t data_size(const framebuffer_t* buffer)
+{
+    // tiled buffers are padded to whole tiles
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_TILED)
+    {
+        return buffer->tiles_x * buffer->tiles_y * TILE_PIXELS;
+    }
+
+    return buffer->height * buffer->pitch;
+}
+
+static void fill_tile(framebuffer_t* buffer, uint32_t tile)
+{
+    uint32_t x0 = (tile % buffer->tiles_x) << FRAMEBUFFER_TILE_SHIFT;
+    uint32_t y0 = (tile / buffer->tiles_x) << FRAMEBUFFER_TILE_SHIFT;
+    uint32_t x1 = x0 + FRAMEBUFFER_TILE_SIZE < buffer->width ? x0 + FRAMEBUFFER_TILE_SIZE : buffer->width;
+    uint32_t y1 = y0 + FRAMEBUFFER_TILE_SIZE < buffer->height ? y0 + FRAMEBUFFER_TILE_SIZE : buffer->height;
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        uint32_t* row = &buffer->data[pixel_index(buffer, x0, y)];
+
+        for (uint32_t x = 0; x < x1 - x0; x++)
+        {
+            row[x] = buffer->clear_color;
+        }
+    }
+
+    buffer->cleared[tile] = false;
+}
+
+static inline void touch_tile(framebuffer_t* buffer, uint32_t x, uint32_t y)
+{
+    uint32_t tile = tile_index(buffer, x, y);
+
+    if (buffer->cleared[tile])
+    {
+        fill_tile(buffer, tile);
+    }
+}
+
 /********************/
 /* public functions */
 /********************/
@@ -31,47 +187,247 @@ framebuffer_t* framebuffer_new(uint32_t width, uint32_t height)
 {
     assert(width > 0 && height > 0);
 
+    framebuffer_t* buffer = framebuffer_wrap(width, height, width, malloc(height * width * sizeof(uint32_t)));
+    buffer->owned = true;
+
+    framebuffer_clear(buffer);
+
+    return buffer;
+}
+
+framebuffer_t* framebuffer_wrap(uint32_t width, uint32_t height, uint32_t pitch, uint32_t* data)
+{
+    // memory owned by someone else, e.g. the image the display presents, rows may be padded
+    assert(width > 0 && height > 0 && pitch >= width && data);
+
     framebuffer_t* buffer = malloc(sizeof(framebuffer_t));
     buffer->width = width;
     buffer->height = height;
-    buffer->origin = width * height - width;
-    buffer->data = malloc(width * height * sizeof(unsigned char) * RGB_CHANNELS);
-
-    framebuffer_clear(buffer);
+    buffer->pitch = pitch;
+    buffer->tiles_x = (width + TILE_MASK) >> FRAMEBUFFER_TILE_SHIFT;
+    buffer->tiles_y = (height + TILE_MASK) >> FRAMEBUFFER_TILE_SHIFT;
+    buffer->layout = FRAMEBUFFER_LAYOUT_LINEAR;
+    buffer->data = data;
+    buffer->cleared = calloc(buffer->tiles_x * buffer->tiles_y, sizeof(bool));
+    buffer->clear_color = FRAMEBUFFER_CLEAR_COLOR;
+    buffer->owned = false;
 
     return buffer;
 }
 
-void framebuffer_set(framebuffer_t* buffer, uint32_t x, uint32_t y, uint32_t val)
+void framebuffer_set_layout(framebuffer_t* buffer, framebuffer_layout_e layout)
 {
-    uint32_t index = (buffer->origin - y * buffer->width + x) * RGB_CHANNELS;
+    // the pixels move with the layout, tiles are numbered the same in both so cleared tiles stay cleared
+    assert(buffer->owned);
 
-    buffer->data[index + 0] = (unsigned char)(val >> 24);
-    buffer->data[index + 1] = (unsigned char)(val >> 16);
-    buffer->data[index + 2] = (unsigned char)(val >> 8);
-    buffer->data[index + 3] = (unsigned char)(val);
+    if (buffer->layout == layout)
+    {
+        return;
+    }
+
+    framebuffer_t source = *buffer;
+
+    buffer->layout = layout;
+    buffer->pitch = buffer->width;
+    buffer->data = malloc(data_size(buffer) * sizeof(uint32_t));
+
+    for (uint32_t y = 0; y < buffer->height; y++)
+    {
+        for (uint32_t x = 0; x < buffer->width; x++)
+        {
+            buffer->data[pixel_index(buffer, x, y)] = source.data[pixel_index(&source, x, y)];
+        }
+    }
+
+    free(source.data);
+}
+
+void framebuffer_set(framebuffer_t* buffer, uint32_t x, uint32_t y, uint32_t val)
+{
+    touch_tile(buffer, x, y);
+    buffer->data[pixel_index(buffer, x, y)] = val;
 }
 
 uint32_t framebuffer_get(framebuffer_t* buffer, uint32_t x, uint32_t y)
 {
-    uint32_t index = (buffer->origin - y * buffer->width + x) * RGB_CHANNELS;
+    if (buffer->cleared[tile_index(buffer, x, y)])
+    {
+        return buffer->clear_color;
+    }
+
+    return buffer->data[pixel_index(buffer, x, y)];
+}
+
+void framebuffer_write_span(framebuffer_t* buffer, uint32_t x, uint32_t y, const uint32_t* colors, uint32_t count)
+{
+    assert(count > 0 && x + count <= buffer->width && y < buffer->height);
+
+    if (buffer->layout == FRAMEBUFFER_LAYOUT_LINEAR)
+    {
+        for (uint32_t tx = x & ~(uint32_t)TILE_MASK; tx < x + count; tx += FRAMEBUFFER_TILE_SIZE)
+        {
+            touch_tile(buffer, tx, y);
+        }
+
+        // one copy per run of covered pixels, the compiler turns it into vector stores
+        memcpy(&buffer->data[y * buffer->pitch + x], colors, count * sizeof(uint32_t));
+        return;
+    }
 
-    uint32_t color = 0;
-    color += buffer->data[index + 0] << 24;
-    color += buffer->data[index + 1] << 16;
-    color += buffer->data[index + 2] << 8;
-    color += buffer->data[index + 3] << 0;
+    // one copy per tile the run crosses
+    while (count > 0)
+    {
+        uint32_t size = FRAMEBUFFER_TILE_SIZE - (x & TILE_MASK);
+        size = size < count ? size : count;
 
-    return color;
+        touch_tile(buffer, x, y);
+        memcpy(&buffer->data[pixel_index(buffer, x, y)], colors, size * sizeof(uint32_t));
+
+        x += size;
+        colors += size;
+        count -= size;
+    }
+}
+
+void framebuffer_detile(const framebuffer_t* source, framebuffer_t* target)
+{
+    assert(source->layout == FRAMEBUFFER_LAYOUT_TILED && target->layout == FRAMEBUFFER_LAYOUT_LINEAR);
+    assert(source->width == target->width && source->height == target->height);
+
+    // tile rows are read in order, every tile row is a short contiguous run of the target row
+    for (uint32_t y = 0; y < source->height; y++)
+    {
+        const uint32_t* tile_row = &source->data[pixel_index(source, 0, y)];
+        const bool* cleared = &source->cleared[tile_index(source, 0, y)];
+        uint32_t* row = &target->data[y * target->pitch];
+
+        for (uint32_t x = 0; x < source->width; x += FRAMEBUFFER_TILE_SIZE)
+        {
+            uint32_t size = source->width - x < FRAMEBUFFER_TILE_SIZE ? source->width - x : FRAMEBUFFER_TILE_SIZE;
+
+            if (!cleared[x >> FRAMEBUFFER_TILE_SHIFT])
+            {
+                memcpy(&row[x], &tile_row[(x >> FRAMEBUFFER_TILE_SHIFT) * TILE_PIXELS], size * sizeof(uint32_t));
+                continue;
+            }
+
+            // never drawn to, filled here instead of at clear time
+            for (uint32_t i = 0; i < size; i++)
+            {
+                row[x + i] = source->clear_color;
+            }
+        }
+    }
+
+    // every pixel of the target was written
+    memset(target->cleared, 0, target->tiles_x * target->tiles_y * sizeof(bool));
+}
+
+void framebuffer_upscale(const framebuffer_upscale_table_t* table, framebuffer_t* source, framebuffer_t* target)
+{
+    assert(target->layout == FRAMEBUFFER_LAYOUT_LINEAR);
+    assert(table->source_width == source->width && table->source_height == source->height);
+    assert(table->source_layout == source->layout);
+    assert(table->target_width == target->width && table->target_height == target->height);
+
+    // read straight from memory below
+    framebuffer_resolve_clear(source);
+
+    for (uint32_t y = 0; y < target->height; y++)
+    {
+        const uint32_t* top = &source->data[table->rows[2 * y + 0]];
+        const uint32_t* bot = &source->data[table->rows[2 * y + 1]];
+        uint32_t wy         = table->row_w[y];
+        uint32_t* row       = &target->data[y * target->pitch];
+
+        for (uint32_t x = 0; x < target->width; x++)
+        {
+            uint32_t c0 = table->columns[2 * x + 0];
+            uint32_t c1 = table->columns[2 * x + 1];
+
+            row[x] = bilerp(top[c0], top[c1], bot[c0], bot[c1], table->column_w[x], wy);
+        }
+    }
+
+    // every pixel of the target was written
+    memset(target->cleared, 0, target->tiles_x * target->tiles_y * sizeof(bool));
+}
+
+framebuffer_upscale_table_t* framebuffer_upscale_table_new(const framebuffer_t* source, const framebuffer_t* target)
+{
+    // depends on the sizes and the source layout only, built once per resize
+    framebuffer_upscale_table_t* table  = malloc(sizeof(framebuffer_upscale_table_t));
+    table->source_width                 = source->width;
+    table->source_height                = source->height;
+    table->source_layout                = source->layout;
+    table->target_width                 = target->width;
+    table->target_height                = target->height;
+    table->columns                      = malloc(2 * target->width * sizeof(uint32_t));
+    table->column_w                     = malloc(target->width * sizeof(uint32_t));
+    table->rows                         = malloc(2 * target->height * sizeof(uint32_t));
+    table->row_w                        = malloc(target->height * sizeof(uint32_t));
+
+    uint32_t* first                     = malloc((target->width > target->height ? target->width : target->height) * sizeof(uint32_t));
+
+    upscale_axis(source->width, target->width, first, table->column_w);
+
+    for (uint32_t x = 0; x < target->width; x++)
+    {
+        uint32_t left                   = first[x];
+        uint32_t right                  = left + 1 < source->width ? left + 1 : left;
+        table->columns[2 * x + 0]       = column_offset(source, left);
+        table->columns[2 * x + 1]       = column_offset(source, right);
+    }
+
+    upscale_axis(source->height, target->height, first, table->row_w);
+
+    for (uint32_t y = 0; y < target->height; y++)
+    {
+        uint32_t top                    = first[y];
+        uint32_t bottom                 = top + 1 < source->height ? top + 1 : top;
+        table->rows[2 * y + 0]          = row_offset(source, top);
+        table->rows[2 * y + 1]          = row_offset(source, bottom);
+    }
+
+    free(first);
+
+    return table;
+}
+
+void framebuffer_upscale_table_free(framebuffer_upscale_table_t* table)
+{
+    free(table->columns);
+    free(table->column_w);
+    free(table->rows);
+    free(table->row_w);
+    free(table);
+}
+
+void framebuffer_resolve_clear(framebuffer_t* buffer)
+{
+    // fills the tiles nothing was drawn to, before the memory is read directly
+    for (uint32_t tile = 0; tile < buffer->tiles_x * buffer->tiles_y; tile++)
+    {
+        if (buffer->cleared[tile])
+        {
+            fill_tile(buffer, tile);
+        }
+    }
 }
 
 void framebuffer_clear(framebuffer_t* buffer)
 {
-    memset(buffer->data, 120, buffer->width * buffer->height * sizeof(unsigned char) * RGB_CHANNELS);
+    buffer->clear_color = FRAMEBUFFER_CLEAR_COLOR;
+    memset(buffer->cleared, 1, buffer->tiles_x * buffer->tiles_y * sizeof(bool));
 }
 
 void framebuffer_free(framebuffer_t* buffer)
 {
-    free(buffer->data);
+    if (buffer->owned)
+    {
+        free(buffer->data);
+    }
+
+    free(buffer->cleared);
     free(buffer);
 }
\ No newline at end of file
@@ -1,18 +1,57 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define FRAMEBUFFER_TILE_SHIFT  3 /* 8x8 pixel tiles, 4 for 16x16 */
+#define FRAMEBUFFER_TILE_SIZE   (1 << FRAMEBUFFER_TILE_SHIFT)
+#define FRAMEBUFFER_CLEAR_COLOR 0x78787878
+
+typedef enum
+{
+    FRAMEBUFFER_LAYOUT_LINEAR = 0,  /* rows top first, pitch pixels apart */
+    FRAMEBUFFER_LAYOUT_TILED        /* row major tiles, row major pixels inside a tile */
+} framebuffer_layout_e;
 
 typedef struct
 {
-    uint32_t        width;
-    uint32_t        height;
-    uint32_t        origin;
-    unsigned char*  data;       // BGRA
+    uint32_t                width;
+    uint32_t                height;
+    uint32_t                pitch;      // pixels per row, rows may be padded
+    uint32_t                tiles_x;
+    uint32_t                tiles_y;
+    framebuffer_layout_e    layout;
+    uint32_t*               data;       // 0xAARRGGBB, B G R A in memory, the row at y = 0 is the top of the image
+    bool*                   cleared;    // per tile, not written since the last clear, its pixels are stale
+    uint32_t                clear_color;
+    bool                    owned;      // data is freed with the framebuffer
 
 } framebuffer_t;
 
+typedef struct
+{
+    uint32_t                source_width;
+    uint32_t                source_height;
+    framebuffer_layout_e    source_layout;
+    uint32_t                target_width;
+    uint32_t                target_height;
+    uint32_t*               columns;    // source offsets of the left and right pixel of every target column
+    uint32_t*               column_w;   // weight of the right pixel, 8 bit
+    uint32_t*               rows;       // source offsets of the top and bottom row of every target row
+    uint32_t*               row_w;      // weight of the bottom row, 8 bit
+
+} framebuffer_upscale_table_t;
+
 framebuffer_t*  framebuffer_new(uint32_t width, uint32_t height);
+framebuffer_t*  framebuffer_wrap(uint32_t width, uint32_t height, uint32_t pitch, uint32_t* data);
+void            framebuffer_set_layout(framebuffer_t* buffer, framebuffer_layout_e layout);
 void            framebuffer_set(framebuffer_t* buffer, uint32_t x, uint32_t y, uint32_t color);
 uint32_t        framebuffer_get(framebuffer_t* buffer, uint32_t x, uint32_t y);
+void            framebuffer_write_span(framebuffer_t* buffer, uint32_t x, uint32_t y, const uint32_t* colors, uint32_t count);
+void            framebuffer_detile(const framebuffer_t* source, framebuffer_t* target);
+void            framebuffer_upscale(const framebuffer_upscale_table_t* table, framebuffer_t* source, framebuffer_t* target);
+framebuffer_upscale_table_t* framebuffer_upscale_table_new(const framebuffer_t* source, const framebuffer_t* target);
+void            framebuffer_upscale_table_free(framebuffer_upscale_table_t* table);
+void            framebuffer_resolve_clear(framebuffer_t* buffer);
 void            framebuffer_clear(framebuffer_t* buffer);
 void            framebuffer_free(framebuffer_t* buffer);
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "headless.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "input_script.h"
+#include "settings.h"
+
+/********************
+ *  Notes
+ *
+ * Display backend without a window or a server. The images are plain framebuffers, the last frames stay in them
+ * and every presented frame is optionally written to the dump directory as frame_00000.ppm, frame_00001.ppm...
+ * Input comes from the input script, the run quits after get_headless_frames() frames unless the script quits
+ * first. Frames are written on the presenter thread, rendering is not slowed down by the disk.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define DUMP_PATH_SIZE 512
+
+/********************/
+/* static variables */
+/********************/
+
+static input_script_t* script   = NULL;
+static uint32_t frames_drawn    = 0;
+
+/********************/
+/* static functions */
+/********************/
+
+static void dump_frame(const framebuffer_t* framebuffer, const char* directory, uint32_t index)
+{
+    char path[DUMP_PATH_SIZE];
+    snprintf(path, DUMP_PATH_SIZE, "%s/frame_%05u.ppm", directory, index);
+
+    FILE* handle = fopen(path, "wb");
+
+    // a missing frame is not fatal, the run goes on
+    if (!handle)
+    {
+        printf("could not write frame: %s\n", path);
+        return;
+    }
+
+    fprintf(handle, "P6\n%u %u\n255\n", framebuffer->width, framebuffer->height);
+
+    unsigned char* row = malloc(framebuffer->width * 3);
+
+    for (uint32_t y = 0; y < framebuffer->height; y++)
+    {
+        const uint32_t* pixels = &framebuffer->data[y * framebuffer->pitch];
+
+        for (uint32_t x = 0; x < framebuffer->width; x++)
+        {
+            row[x * 3 + 0] = (unsigned char)(pixels[x] >> 16);
+            row[x * 3 + 1] = (unsigned char)(pixels[x] >> 8);
+            row[x * 3 + 2] = (unsigned char)(pixels[x]);
+        }
+
+        fwrite(row, 3, framebuffer->width, handle);
+    }
+
+    free(row);
+    fclose(handle);
+}
+
+static void images_init(display_t* dsp, uint32_t width, uint32_t height)
+{
+    dsp->width  = width;
+    dsp->height = height;
+
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        dsp->framebuffers[i] = framebuffer_new(width, height);
+    }
+}
+
+static void images_free(display_t* dsp)
+{
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        framebuffer_free(dsp->framebuffers[i]);
+        dsp->framebuffers[i] = NULL;
+    }
+}
+
+static void headless_resize(display_t* dsp, uint32_t width, uint32_t height)
+{
+    // the script keeps running
+    images_free(dsp);
+    images_init(dsp, width, height);
+}
+
+static void headless_wait(display_t* dsp, const framebuffer_t* framebuffer)
+{
+    // nothing reads the images after headless_draw returns
+    (void)dsp;
+    (void)framebuffer;
+}
+
+static void headless_draw(display_t* dsp, const framebuffer_t* framebuffer)
+{
+    (void)dsp;
+
+    if (get_frame_dump())
+    {
+        dump_frame(framebuffer, get_frame_dump(), frames_drawn);
+    }
+
+    frames_drawn++;
+}
+
+static void headless_clear(display_t* dsp)
+{
+    (void)dsp;
+}
+
+static input_t headless_input(display_t* dsp)
+{
+    (void)dsp;
+
+    return input_script_next(script);
+}
+
+static void headless_free(display_t* dsp)
+{
+    images_free(dsp);
+    input_script_free(script);
+    script = NULL;
+}
+
+static const display_backend_t headless_backend =
+{
+    .resize = headless_resize,
+    .wait   = headless_wait,
+    .draw   = headless_draw,
+    .clear  = headless_clear,
+    .input  = headless_input,
+    .free   = headless_free
+};
+
+/********************/
+/* public functions */
+/********************/
+
+void headless_init(display_t* dsp, uint32_t width, uint32_t height)
+{
+    dsp->backend    = &headless_backend;
+
+    images_init(dsp, width, height);
+
+    script          = input_script_new(get_input_script(), get_headless_frames());
+    frames_drawn    = 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "display.h"
+
+void    headless_init(display_t* dsp, uint32_t width, uint32_t height);
@@ -0,0 +1,615 @@
+#include "ibl.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#include "file.h"
+#include "atomic_types.h"
+#include "parsers/png.h"
+#include "parsers/crc.h"
+
+/********************
+ *  Notes
+ *
+ * - unreal pbr paper   - https://cdn2.unrealengine.com/Resources/files/2013SiggraphPresentationsNotes-26915738.pdf
+ * - SH irradiance      - https://graphics.stanford.edu/papers/envmap/envmap.pdf
+ * - LearnOpengl IBL    - https://learnopengl.com/PBR/IBL/Specular-IBL
+ * - GPU Gems 3 ch. 20  - https://developer.nvidia.com/gpugems/gpugems3/part-iii-rendering/chapter-20-gpu-based-importance-sampling
+ *
+ * Split sum image based lighting. Everything expensive is done once at load time:
+ *  - the environment is box filtered down to the base level and projected on 9 SH coefficients (diffuse)
+ *  - every other specular level is the GGX prefiltered environment for increasing roughness. The samples are
+ *    taken from a box filtered radiance chain to avoid noise (filtered importance sampling)
+ *  - the BRDF integration LUT holds the scale and bias applied to F0
+ * The prefilter and the LUT are split in rows and computed by a small thread pool. The result is written
+ * next to the environment (<file>.ibl) and reused as long as the crc of the environment matches.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define IBL_MAGIC               0x304C4249      /* IBL0 */
+#define IBL_VERSION             1
+#define IBL_BASE_WIDTH          256
+#define IBL_BASE_HEIGHT         128
+#define IBL_RADIANCE_LEVELS     8
+#define IBL_PREFILTER_SAMPLES   64
+#define IBL_LUT_SAMPLES         128
+#define IBL_THREAD_COUNT        4
+
+/********************/
+/* static variables */
+/********************/
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t source_crc;
+    uint32_t levels;
+    uint32_t base_width;
+    uint32_t base_height;
+    uint32_t lut_size;
+} cache_header_t;
+
+typedef struct
+{
+    atomic_uint32_t*    index;
+    uint32_t            size;
+    ibl_t*              ibl;
+    const ibl_level_t*  radiance;
+} job_args_t;
+
+/********************/
+/* static functions */
+/********************/
+
+static ibl_level_t level_new(uint32_t width, uint32_t height)
+{
+    ibl_level_t level   = { .width = width, .height = height };
+    level.data          = malloc(sizeof(float) * 3 * width * height);
+
+    return level;
+}
+
+static vec4_t level_get(const ibl_level_t* level, uint32_t x, uint32_t y)
+{
+    const float* texel = &level->data[(y * level->width + x) * 3];
+
+    return vec4_new(texel[0], texel[1], texel[2]);
+}
+
+static void level_set(ibl_level_t* level, uint32_t x, uint32_t y, vec4_t c)
+{
+    float* texel = &level->data[(y * level->width + x) * 3];
+
+    texel[0] = c.x;
+    texel[1] = c.y;
+    texel[2] = c.z;
+}
+
+static vec4_t texel_direction(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    float phi       = (((float)x + 0.5f) / (float)width - 0.5f) * 2.f * F_PI;
+    float theta     = ((float)y + 0.5f) / (float)height * F_PI;
+
+    return vec4_new(f_sin(theta) * f_cos(phi), f_cos(theta), f_sin(theta) * f_sin(phi));
+}
+
+// bilinear lookup, wraps horizontally and clamps vertically
+static vec4_t level_sample(const ibl_level_t* level, vec4_t dir)
+{
+    float u     = atan2f(dir.z, dir.x) / (2.f * F_PI) + 0.5f;
+    float v     = acosf(f_clamp(dir.y, -1.f, 1.f)) / F_PI;
+
+    float x     = u * (float)level->width - 0.5f;
+    float y     = f_clamp(v * (float)level->height - 0.5f, 0.f, (float)level->height - 1.f);
+    float x0    = f_floor(x);
+    float y0    = f_floor(y);
+    float fx    = x - x0;
+    float fy    = y - y0;
+
+    int32_t w   = (int32_t)level->width;
+    uint32_t x1 = (uint32_t)((((int32_t)x0 % w) + w) % w);
+    uint32_t x2 = (x1 + 1) % level->width;
+    uint32_t y1 = (uint32_t)y0;
+    uint32_t y2 = u_min(y1 + 1, level->height - 1);
+
+    vec4_t top  = vec4_add(vec4_scale(level_get(level, x1, y1), 1.f - fx), vec4_scale(level_get(level, x2, y1), fx));
+    vec4_t bot  = vec4_add(vec4_scale(level_get(level, x1, y2), 1.f - fx), vec4_scale(level_get(level, x2, y2), fx));
+
+    return vec4_add(vec4_scale(top, 1.f - fy), vec4_scale(bot, fy));
+}
+
+static ibl_level_t level_downsample(const ibl_level_t* src, uint32_t width, uint32_t height)
+{
+    ibl_level_t dst = level_new(width, height);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        uint32_t y0 = y * src->height / height;
+        uint32_t y1 = u_max((y + 1) * src->height / height, y0 + 1);
+
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint32_t x0 = x * src->width / width;
+            uint32_t x1 = u_max((x + 1) * src->width / width, x0 + 1);
+            vec4_t sum  = vec4_from_scalar(0.f);
+
+            for (uint32_t j = y0; j < y1; j++)
+            {
+                for (uint32_t i = x0; i < x1; i++)
+                {
+                    sum = vec4_add(sum, level_get(src, i, j));
+                }
+            }
+
+            level_set(&dst, x, y, vec4_scale(sum, 1.f / (float)((x1 - x0) * (y1 - y0))));
+        }
+    }
+
+    return dst;
+}
+
+static vec2_t hammersley(uint32_t i, uint32_t n)
+{
+    uint32_t bits = i;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+    return vec2_new((float)i / (float)n, (float)bits * 2.3283064365386963e-10f);
+}
+
+// GGX distributed halfway vector around n, a = roughness^2
+static vec4_t importance_sample_ggx(vec2_t xi, vec4_t n, float a)
+{
+    float phi       = 2.f * F_PI * xi.x;
+    float cos_theta = sqrtf((1.f - xi.y) / (1.f + (a * a - 1.f) * xi.y));
+    float sin_theta = sqrtf(1.f - cos_theta * cos_theta);
+
+    vec4_t up       = f_abs(n.y) < 0.999f ? vec4_new(0.f, 1.f, 0.f) : vec4_new(1.f, 0.f, 0.f);
+    vec4_t tangent  = vec4_normalize(vec4_cross(up, n));
+    vec4_t bitan    = vec4_cross(n, tangent);
+
+    vec4_t h        = vec4_scale(tangent, sin_theta * f_cos(phi));
+    h               = vec4_add(h, vec4_scale(bitan, sin_theta * f_sin(phi)));
+    h               = vec4_add(h, vec4_scale(n, cos_theta));
+
+    return vec4_normalize(h);
+}
+
+static float geometry_smith(float n_dot_v, float n_dot_l, float roughness)
+{
+    float k     = roughness * roughness / 2.f;
+    float g_v   = n_dot_v / (n_dot_v * (1.f - k) + k);
+    float g_l   = n_dot_l / (n_dot_l * (1.f - k) + k);
+
+    return g_v * g_l;
+}
+
+static void prefilter_row(ibl_level_t* level, const ibl_level_t* radiance, float roughness, uint32_t y)
+{
+    float a             = roughness * roughness;
+    float texel_angle   = 4.f * F_PI / (float)(radiance[0].width * radiance[0].height);
+
+    for (uint32_t x = 0; x < level->width; x++)
+    {
+        // n = v = r
+        vec4_t n        = texel_direction(x, y, level->width, level->height);
+        vec4_t color    = vec4_from_scalar(0.f);
+        float weight    = 0.f;
+
+        for (uint32_t i = 0; i < IBL_PREFILTER_SAMPLES; i++)
+        {
+            vec4_t h        = importance_sample_ggx(hammersley(i, IBL_PREFILTER_SAMPLES), n, a);
+            float n_dot_h   = f_max(vec4_dot(n, h), 0.f);
+            vec4_t l        = vec4_sub(vec4_scale(h, 2.f * n_dot_h), n);
+            float n_dot_l   = vec4_dot(n, l);
+
+            if (n_dot_l <= 0.f)
+            {
+                continue;
+            }
+
+            // pick the radiance level whose texel covers the solid angle of the sample
+            float b         = n_dot_h * n_dot_h * (a * a - 1.f) + 1.f;
+            float d         = a * a / (F_PI * b * b);
+            float pdf       = d / 4.f + 0.0001f;
+            float angle     = 1.f / ((float)IBL_PREFILTER_SAMPLES * pdf);
+            float mip       = roughness == 0.f ? 0.f : 0.5f * log2f(angle / texel_angle) + 1.f;
+            uint32_t l_mip  = (uint32_t)f_clamp(f_round(mip), 0.f, (float)(IBL_RADIANCE_LEVELS - 1));
+
+            color           = vec4_add(color, vec4_scale(level_sample(&radiance[l_mip], l), n_dot_l));
+            weight         += n_dot_l;
+        }
+
+        level_set(level, x, y, vec4_scale(color, 1.f / f_max(weight, 0.0001f)));
+    }
+}
+
+static void brdf_lut_row(float* lut, uint32_t y)
+{
+    float roughness     = ((float)y + 0.5f) / (float)IBL_LUT_SIZE;
+    vec4_t n            = vec4_new(0.f, 0.f, 1.f);
+
+    for (uint32_t x = 0; x < IBL_LUT_SIZE; x++)
+    {
+        float n_dot_v   = ((float)x + 0.5f) / (float)IBL_LUT_SIZE;
+        vec4_t v        = vec4_new(sqrtf(1.f - n_dot_v * n_dot_v), 0.f, n_dot_v);
+        float scale     = 0.f;
+        float bias      = 0.f;
+
+        for (uint32_t i = 0; i < IBL_LUT_SAMPLES; i++)
+        {
+            vec4_t h        = importance_sample_ggx(hammersley(i, IBL_LUT_SAMPLES), n, roughness * roughness);
+            float v_dot_h   = vec4_dot(v, h);
+            vec4_t l        = vec4_sub(vec4_scale(h, 2.f * v_dot_h), v);
+            float n_dot_l   = f_max(l.z, 0.f);
+            float n_dot_h   = f_max(h.z, 0.f);
+            v_dot_h         = f_max(v_dot_h, 0.f);
+
+            if (n_dot_l <= 0.f)
+            {
+                continue;
+            }
+
+            float g         = geometry_smith(n_dot_v, n_dot_l, roughness);
+            float g_vis     = g * v_dot_h / (n_dot_h * n_dot_v + 0.0001f);
+            float fc        = f_pow(1.f - v_dot_h, 5.f);
+
+            scale          += (1.f - fc) * g_vis;
+            bias           += fc * g_vis;
+        }
+
+        lut[(y * IBL_LUT_SIZE + x) * 2 + 0] = scale / (float)IBL_LUT_SAMPLES;
+        lut[(y * IBL_LUT_SIZE + x) * 2 + 1] = bias / (float)IBL_LUT_SAMPLES;
+    }
+}
+
+static int32_t compute_rows(void* data)
+{
+    job_args_t* args    = (job_args_t*)data;
+    uint32_t index      = (*args->index)++;
+
+    while (index < args->size)
+    {
+        // jobs are the rows of specular levels 1..n followed by the rows of the LUT
+        uint32_t row    = index;
+        uint32_t level  = 1;
+
+        while (level < IBL_SPECULAR_LEVELS && row >= args->ibl->specular[level].height)
+        {
+            row -= args->ibl->specular[level].height;
+            level++;
+        }
+
+        if (level < IBL_SPECULAR_LEVELS)
+        {
+            float roughness = (float)level / (float)(IBL_SPECULAR_LEVELS - 1);
+            prefilter_row(&args->ibl->specular[level], args->radiance, roughness, row);
+        }
+        else
+        {
+            brdf_lut_row(args->ibl->brdf_lut, row);
+        }
+
+        index = (*args->index)++;
+    }
+
+    return thrd_success;
+}
+
+static void project_sh(ibl_t* ibl, const ibl_level_t* level)
+{
+    // band convolution with the cosine lobe, divided by pi so that evaluating gives E / pi
+    const float a[9] = { 1.f, 2.f / 3.f, 2.f / 3.f, 2.f / 3.f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+
+    float d_phi     = 2.f * F_PI / (float)level->width;
+    float d_theta   = F_PI / (float)level->height;
+
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        ibl->sh[i] = vec4_from_scalar(0.f);
+    }
+
+    for (uint32_t y = 0; y < level->height; y++)
+    {
+        for (uint32_t x = 0; x < level->width; x++)
+        {
+            vec4_t d        = texel_direction(x, y, level->width, level->height);
+            float sin_theta = sqrtf(f_max(1.f - d.y * d.y, 0.f));
+            vec4_t c        = vec4_scale(level_get(level, x, y), d_phi * d_theta * sin_theta);
+
+            float basis[9]  = { 0.282095f,
+                                0.488603f * d.y,
+                                0.488603f * d.z,
+                                0.488603f * d.x,
+                                1.092548f * d.x * d.y,
+                                1.092548f * d.y * d.z,
+                                0.315392f * (3.f * d.z * d.z - 1.f),
+                                1.092548f * d.x * d.z,
+                                0.546274f * (d.x * d.x - d.y * d.y) };
+
+            for (uint32_t i = 0; i < 9; i++)
+            {
+                ibl->sh[i] = vec4_add(ibl->sh[i], vec4_scale(c, basis[i]));
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        ibl->sh[i] = vec4_scale(ibl->sh[i], a[i]);
+    }
+}
+
+static uint32_t source_crc(const file_t* file)
+{
+    crc_input_t params = {
+        .buffer = file->data,
+        .size   = file->size,
+        .poly   = CRC_32_POLY,
+        .init   = CRC_32_INIT,
+        .final  = CRC_32_INIT,
+        .config = CRC_REFLECT_INPUT | CRC_REFLECT_OUTPUT
+    };
+
+    return crc(params);
+}
+
+static cache_header_t cache_header(uint32_t crc_value)
+{
+    cache_header_t header = {
+        .magic          = IBL_MAGIC,
+        .version        = IBL_VERSION,
+        .source_crc     = crc_value,
+        .levels         = IBL_SPECULAR_LEVELS,
+        .base_width     = IBL_BASE_WIDTH,
+        .base_height    = IBL_BASE_HEIGHT,
+        .lut_size       = IBL_LUT_SIZE
+    };
+
+    return header;
+}
+
+static ibl_t* cache_load(const char* cache_path, uint32_t crc_value)
+{
+    FILE* handle = fopen(cache_path, "rb");
+
+    if (!handle)
+    {
+        return NULL;
+    }
+
+    cache_header_t header   = cache_header(crc_value);
+    cache_header_t actual;
+
+    if (fread(&actual, sizeof(cache_header_t), 1, handle) != 1 ||
+        memcmp(&actual, &header, sizeof(cache_header_t)) != 0)
+    {
+        fclose(handle);
+        return NULL;
+    }
+
+    ibl_t* ibl      = malloc(sizeof(ibl_t));
+    ibl->brdf_lut   = malloc(sizeof(float) * IBL_LUT_SIZE * IBL_LUT_SIZE * 2);
+    size_t read     = fread(ibl->sh, sizeof(vec4_t), 9, handle);
+    size_t expected = 9 + IBL_LUT_SIZE * IBL_LUT_SIZE;
+
+    for (uint32_t i = 0; i < IBL_SPECULAR_LEVELS; i++)
+    {
+        ibl_level_t* level  = &ibl->specular[i];
+        *level              = level_new(u_max(IBL_BASE_WIDTH >> i, 1), u_max(IBL_BASE_HEIGHT >> i, 1));
+        read               += fread(level->data, sizeof(float) * 3, level->width * level->height, handle);
+        expected           += level->width * level->height;
+    }
+
+    read += fread(ibl->brdf_lut, sizeof(float) * 2, IBL_LUT_SIZE * IBL_LUT_SIZE, handle);
+    fclose(handle);
+
+    // truncated cache, recompute
+    if (read != expected)
+    {
+        ibl_free(ibl);
+        return NULL;
+    }
+
+    return ibl;
+}
+
+static void cache_save(const ibl_t* ibl, const char* cache_path, uint32_t crc_value)
+{
+    FILE* handle = fopen(cache_path, "wb");
+
+    // not being able to cache is not fatal, we will just recompute next time
+    if (!handle)
+    {
+        printf("could not write ibl cache: %s\n", cache_path);
+        return;
+    }
+
+    cache_header_t header = cache_header(crc_value);
+
+    fwrite(&header, sizeof(cache_header_t), 1, handle);
+    fwrite(ibl->sh, sizeof(vec4_t), 9, handle);
+
+    for (uint32_t i = 0; i < IBL_SPECULAR_LEVELS; i++)
+    {
+        const ibl_level_t* level = &ibl->specular[i];
+        fwrite(level->data, sizeof(float) * 3, level->width * level->height, handle);
+    }
+
+    fwrite(ibl->brdf_lut, sizeof(float) * 2, IBL_LUT_SIZE * IBL_LUT_SIZE, handle);
+    fclose(handle);
+}
+
+/********************/
+/* public functions */
+/********************/
+
+ibl_t* ibl_new(const char* file_path)
+{
+    char cache_path[512];
+    snprintf(cache_path, sizeof(cache_path), "%s.ibl", file_path);
+
+    file_t* file        = file_new(file_path);
+    uint32_t crc_value  = source_crc(file);
+    ibl_t* ibl          = cache_load(cache_path, crc_value);
+
+    if (!ibl)
+    {
+        texture_t* environment  = parse_png(file->data, file->size);
+        ibl                     = ibl_compute(environment);
+
+        cache_save(ibl, cache_path, crc_value);
+        texture_free(environment);
+    }
+
+    file_free(file);
+
+    return ibl;
+}
+
+ibl_t* ibl_compute(const texture_t* environment)
+{
+    ibl_t* ibl              = malloc(sizeof(ibl_t));
+    ibl->brdf_lut           = malloc(sizeof(float) * IBL_LUT_SIZE * IBL_LUT_SIZE * 2);
+
+    // linearize the environment (stored as sRGB RGB(A))
+    ibl_level_t source      = level_new(environment->width, environment->height);
+    const unsigned char* d  = environment->data;
+    uint32_t stride         = environment->stride;
+
+    for (uint32_t i = 0; i < environment->width * environment->height; i++)
+    {
+        source.data[i * 3 + 0] = f_pow((float)d[i * stride + 2] / 255.f, 2.2f);
+        source.data[i * 3 + 1] = f_pow((float)d[i * stride + 1] / 255.f, 2.2f);
+        source.data[i * 3 + 2] = f_pow((float)d[i * stride + 0] / 255.f, 2.2f);
+    }
+
+    // box filtered radiance chain, the first level doubles as the mirror specular level
+    ibl_level_t radiance[IBL_RADIANCE_LEVELS];
+    radiance[0] = level_downsample(&source, IBL_BASE_WIDTH, IBL_BASE_HEIGHT);
+
+    for (uint32_t i = 1; i < IBL_RADIANCE_LEVELS; i++)
+    {
+        radiance[i] = level_downsample(&radiance[i - 1],
+                                       u_max(radiance[i - 1].width / 2, 1),
+                                       u_max(radiance[i - 1].height / 2, 1));
+    }
+
+    project_sh(ibl, &radiance[0]);
+
+    ibl->specular[0]        = level_downsample(&radiance[0], IBL_BASE_WIDTH, IBL_BASE_HEIGHT);
+    uint32_t jobs           = IBL_LUT_SIZE;
+
+    for (uint32_t i = 1; i < IBL_SPECULAR_LEVELS; i++)
+    {
+        ibl->specular[i]    = level_new(u_max(IBL_BASE_WIDTH >> i, 1), u_max(IBL_BASE_HEIGHT >> i, 1));
+        jobs               += ibl->specular[i].height;
+    }
+
+    // prefilter + LUT rows in parallel
+    thrd_t threads[IBL_THREAD_COUNT];
+    atomic_uint32_t index   = 0;
+    job_args_t args         = { .index      = &index,
+                                .size       = jobs,
+                                .ibl        = ibl,
+                                .radiance   = radiance };
+    int32_t success;
+
+    for (int32_t i = 0; i < IBL_THREAD_COUNT; i++)
+    {
+        success = thrd_create(&threads[i], compute_rows, (void*)&args);
+        assert(success == thrd_success);
+    }
+
+    for (int32_t i = 0; i < IBL_THREAD_COUNT; i++)
+    {
+        thrd_join(threads[i], &success);
+        assert(success == thrd_success);
+    }
+
+    for (uint32_t i = 0; i < IBL_RADIANCE_LEVELS; i++)
+    {
+        free(radiance[i].data);
+    }
+
+    free(source.data);
+
+    return ibl;
+}
+
+vec4_t ibl_irradiance(const ibl_t* ibl, vec4_t n)
+{
+    // returns E(n) / pi, multiply by the albedo to get the diffuse radiance
+    const vec4_t* sh    = ibl->sh;
+    vec4_t result       = vec4_scale(sh[0], 0.282095f);
+
+    result = vec4_add(result, vec4_scale(sh[1], 0.488603f * n.y));
+    result = vec4_add(result, vec4_scale(sh[2], 0.488603f * n.z));
+    result = vec4_add(result, vec4_scale(sh[3], 0.488603f * n.x));
+    result = vec4_add(result, vec4_scale(sh[4], 1.092548f * n.x * n.y));
+    result = vec4_add(result, vec4_scale(sh[5], 1.092548f * n.y * n.z));
+    result = vec4_add(result, vec4_scale(sh[6], 0.315392f * (3.f * n.z * n.z - 1.f)));
+    result = vec4_add(result, vec4_scale(sh[7], 1.092548f * n.x * n.z));
+    result = vec4_add(result, vec4_scale(sh[8], 0.546274f * (n.x * n.x - n.y * n.y)));
+
+    return vec4_new(f_max(result.x, 0.f), f_max(result.y, 0.f), f_max(result.z, 0.f));
+}
+
+vec4_t ibl_specular(const ibl_t* ibl, vec4_t r, float roughness)
+{
+    float level     = f_clamp(roughness, 0.f, 1.f) * (float)(IBL_SPECULAR_LEVELS - 1);
+    uint32_t l0     = (uint32_t)level;
+    uint32_t l1     = u_min(l0 + 1, IBL_SPECULAR_LEVELS - 1);
+    float t         = level - (float)l0;
+
+    vec4_t c0       = level_sample(&ibl->specular[l0], r);
+    vec4_t c1       = level_sample(&ibl->specular[l1], r);
+
+    return vec4_add(vec4_scale(c0, 1.f - t), vec4_scale(c1, t));
+}
+
+vec2_t ibl_brdf(const ibl_t* ibl, float n_dot_v, float roughness)
+{
+    // bilinear between texel centres, a nearest lookup bands across the 32 steps
+    float size      = (float)IBL_LUT_SIZE;
+    float fx        = f_clamp(n_dot_v * size - 0.5f, 0.f, size - 1.f);
+    float fy        = f_clamp(roughness * size - 0.5f, 0.f, size - 1.f);
+    uint32_t x0     = (uint32_t)fx;
+    uint32_t y0     = (uint32_t)fy;
+    uint32_t x1     = u_min(x0 + 1, IBL_LUT_SIZE - 1);
+    uint32_t y1     = u_min(y0 + 1, IBL_LUT_SIZE - 1);
+    float tx        = fx - (float)x0;
+    float ty        = fy - (float)y0;
+
+    const float* c00    = &ibl->brdf_lut[(y0 * IBL_LUT_SIZE + x0) * 2];
+    const float* c10    = &ibl->brdf_lut[(y0 * IBL_LUT_SIZE + x1) * 2];
+    const float* c01    = &ibl->brdf_lut[(y1 * IBL_LUT_SIZE + x0) * 2];
+    const float* c11    = &ibl->brdf_lut[(y1 * IBL_LUT_SIZE + x1) * 2];
+
+    float scale     = (c00[0] * (1.f - tx) + c10[0] * tx) * (1.f - ty) + (c01[0] * (1.f - tx) + c11[0] * tx) * ty;
+    float bias      = (c00[1] * (1.f - tx) + c10[1] * tx) * (1.f - ty) + (c01[1] * (1.f - tx) + c11[1] * tx) * ty;
+
+    return vec2_new(scale, bias);
+}
+
+void ibl_free(ibl_t* ibl)
+{
+    for (uint32_t i = 0; i < IBL_SPECULAR_LEVELS; i++)
+    {
+        free(ibl->specular[i].data);
+    }
+
+    free(ibl->brdf_lut);
+    free(ibl);
+}
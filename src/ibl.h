@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "math.h"
+#include "texture.h"
+
+#define IBL_SPECULAR_LEVELS     6
+#define IBL_LUT_SIZE            32
+
+typedef struct
+{
+    uint32_t    width;
+    uint32_t    height;
+    float*      data;       // equirectangular, 3 floats per texel (BGR, linear)
+
+} ibl_level_t;
+
+typedef struct
+{
+    vec4_t      sh[9];                                  // irradiance SH, convolved with the cosine lobe
+    ibl_level_t specular[IBL_SPECULAR_LEVELS];          // GGX prefiltered radiance, roughness 0 -> 1
+    float*      brdf_lut;                               // IBL_LUT_SIZE^2 (scale, bias) pairs
+
+} ibl_t;
+
+ibl_t*  ibl_new(const char* file_path);
+ibl_t*  ibl_compute(const texture_t* environment);
+vec4_t  ibl_irradiance(const ibl_t* ibl, vec4_t n);
+vec4_t  ibl_specular(const ibl_t* ibl, vec4_t r, float roughness);
+vec2_t  ibl_brdf(const ibl_t* ibl, float n_dot_v, float roughness);
+void    ibl_free(ibl_t* ibl);
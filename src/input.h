@@ -2,8 +2,6 @@
 
 #include <stdint.h>
 
-#include "display.h"
-
 #define QUIT            1L << 0
 #define KEY_W           1L << 1
 #define KEY_A           1L << 2
@@ -26,6 +24,6 @@ typedef struct
     int32_t     prev_x;
     int32_t     curr_y;
     int32_t     prev_y;
+    uint32_t    width;      // window size from the last ConfigureNotify, 0 when there was none
+    uint32_t    height;
 } input_t;
-
-input_t handle_input(display_t* dsp);
@@ -0,0 +1,178 @@
+#include "input_script.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/********************
+ *  Notes
+ *
+ * A script is a text file with one event per line, frames count from 0 and never go back:
+ *
+ *      # orbit, switch to SSAO and zoom in
+ *      0   drag 40 0           left button held, the pointer moved by x y
+ *      10  key 3               1-4, pressed for this frame only
+ *      20  pan -5 5            right button held, the pointer moved by x y
+ *      30  scroll up           up or down
+ *      40  resize 1280 720     the window now has this size
+ *      90  quit
+ *
+ * Events of the same frame are merged. Anything not in the format is a broken script and asserts.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define SCRIPT_LINE_SIZE 256
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static uint64_t parse_key(const char* name)
+{
+    if      (strcmp(name, "1") == 0)    { return KEY_1; }
+    else if (strcmp(name, "2") == 0)    { return KEY_2; }
+    else if (strcmp(name, "3") == 0)    { return KEY_3; }
+    else if (strcmp(name, "4") == 0)    { return KEY_4; }
+
+    assert(false);
+
+    return 0;
+}
+
+static script_event_t parse_event(const char* line)
+{
+    script_event_t event    = { 0 };
+    char command[16]        = { 0 };
+    char name[16]           = { 0 };
+    int32_t x               = 0;
+    int32_t y               = 0;
+    int32_t read            = 0;
+
+    int32_t matched         = sscanf(line, "%u %15s %n", &event.frame, command, &read);
+    assert(matched == 2);
+
+    const char* args        = &line[read];
+
+    if (strcmp(command, "key") == 0)
+    {
+        matched             = sscanf(args, "%15s", name);
+        assert(matched == 1);
+        event.input.keys    = parse_key(name);
+    }
+    else if (strcmp(command, "drag") == 0 || strcmp(command, "pan") == 0)
+    {
+        matched             = sscanf(args, "%d %d", &x, &y);
+        assert(matched == 2);
+        event.input.keys    = command[0] == 'd' ? LEFT_CLICK : RIGHT_CLICK;
+        event.input.curr_x  = x;
+        event.input.curr_y  = y;
+    }
+    else if (strcmp(command, "scroll") == 0)
+    {
+        matched             = sscanf(args, "%15s", name);
+        assert(matched == 1 && (strcmp(name, "up") == 0 || strcmp(name, "down") == 0));
+        event.input.keys    = strcmp(name, "up") == 0 ? SCROLL_UP : SCROLL_DOWN;
+    }
+    else if (strcmp(command, "resize") == 0)
+    {
+        matched             = sscanf(args, "%d %d", &x, &y);
+        assert(matched == 2 && x > 0 && y > 0);
+        event.input.width   = (uint32_t)x;
+        event.input.height  = (uint32_t)y;
+    }
+    else
+    {
+        assert(strcmp(command, "quit") == 0);
+        event.input.keys    = QUIT;
+    }
+
+    return event;
+}
+
+/********************/
+/* public functions */
+/********************/
+
+input_script_t* input_script_new(const char* file_path, uint32_t frames)
+{
+    input_script_t* script  = calloc(1, sizeof(input_script_t));
+    script->frames          = frames;
+
+    // no script, the run only ends after the given frames
+    if (!file_path)
+    {
+        return script;
+    }
+
+    FILE* handle = fopen(file_path, "r");
+    assert(handle != NULL);
+
+    char line[SCRIPT_LINE_SIZE];
+    uint32_t capacity = 0;
+
+    while (fgets(line, SCRIPT_LINE_SIZE, handle))
+    {
+        // comments and blank lines
+        size_t start = strspn(line, " \t\r\n");
+
+        if (line[start] == '\0' || line[start] == '#')
+        {
+            continue;
+        }
+
+        if (script->size == capacity)
+        {
+            capacity        = capacity > 0 ? capacity * 2 : 16;
+            script->events  = realloc(script->events, capacity * sizeof(script_event_t));
+        }
+
+        script_event_t event = parse_event(&line[start]);
+        assert(script->size == 0 || script->events[script->size - 1].frame <= event.frame);
+
+        script->events[script->size++] = event;
+    }
+
+    fclose(handle);
+
+    return script;
+}
+
+input_t input_script_next(input_script_t* script)
+{
+    input_t input = { 0 };
+
+    while (script->next < script->size && script->events[script->next].frame == script->frame)
+    {
+        const input_t* event = &script->events[script->next++].input;
+
+        input.keys         |= event->keys;
+        input.curr_x       += event->curr_x;
+        input.curr_y       += event->curr_y;
+        input.width         = event->width > 0 ? event->width : input.width;
+        input.height        = event->height > 0 ? event->height : input.height;
+    }
+
+    script->frame++;
+
+    if (script->frames > 0 && script->frame >= script->frames)
+    {
+        input.keys |= QUIT;
+    }
+
+    return input;
+}
+
+void input_script_free(input_script_t* script)
+{
+    free(script->events);
+    free(script);
+}
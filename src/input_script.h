@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "input.h"
+
+typedef struct
+{
+    uint32_t    frame;
+    input_t     input;          // what the event adds to the input of its frame
+
+} script_event_t;
+
+// input of a run without a window, see input_script.c for the format
+typedef struct
+{
+    script_event_t* events;     // ordered by frame
+    uint32_t        size;
+    uint32_t        next;       // first event not handed out yet
+    uint32_t        frame;      // frame the next call returns the input of
+    uint32_t        frames;     // quit is set on the last frame, 0 runs until a quit event
+
+} input_script_t;
+
+input_script_t* input_script_new(const char* file_path, uint32_t frames);
+input_t         input_script_next(input_script_t* script);
+void            input_script_free(input_script_t* script);
@@ -0,0 +1,227 @@
+#include "light.h"
+
+#include <math.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/********************
+ *  Notes
+ *
+ * - Tiled shading      - https://www.cse.chalmers.se/~uffe/tiled_shading_preprint.pdf
+ * - glTF punctual      - https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Khronos/KHR_lights_punctual
+ *
+ * The screen is split in LIGHT_TILE_SIZE x LIGHT_TILE_SIZE tiles. Every frame the view space bounding box of each
+ * local light is projected to the screen and the light is appended to all tiles that the rectangle overlaps.
+ * Directional lights and lights without range affect every tile. The fragment shader only loops over the
+ * lights of the tile it is in.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static void light_grid_clear(light_grid_t* grid)
+{
+    uint32_t size = grid->tiles_x * grid->tiles_y;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        grid->tiles[i].size = 0;
+    }
+}
+
+static void light_grid_append(light_grid_t* grid,
+                              uint32_t light,
+                              uint32_t min_tx,
+                              uint32_t min_ty,
+                              uint32_t max_tx,
+                              uint32_t max_ty)
+{
+    for (uint32_t ty = min_ty; ty <= max_ty; ty++)
+    {
+        for (uint32_t tx = min_tx; tx <= max_tx; tx++)
+        {
+            light_tile_t* tile = &grid->tiles[ty * grid->tiles_x + tx];
+
+            // light_grid_build takes at most MAX_LIGHTS lights
+            assert(tile->size < MAX_LIGHTS_PER_TILE);
+
+            tile->indices[tile->size] = (uint8_t)light;
+            tile->size++;
+        }
+    }
+}
+
+/*
+ * light_screen_bounds - projects the view space box around the light's range sphere
+ * and returns false if the light does not touch the screen.
+ */
+static bool light_screen_bounds(const light_t* light,
+                                mat_t V,
+                                mat_t P,
+                                camera_t* cam,
+                                float w,
+                                float h,
+                                vec4_t* min,
+                                vec4_t* max)
+{
+    *min = vec4_new(0.f, 0.f, 0.f);
+    *max = vec4_new(w, h, 0.f);
+
+    if (light->type == DIRECTIONAL_LIGHT || light->range <= 0.f)
+    {
+        return true;
+    }
+
+    float r         = light->range;
+    vec4_t c_v      = mat_mul_vec(V, light->position_w);
+
+    // the view looks down -z, sphere completely behind the camera
+    if (c_v.z - r > 0.f)
+    {
+        return false;
+    }
+
+    // sphere crosses the near plane, be conservative
+    if (c_v.z + r > -cam->n_dist)
+    {
+        return true;
+    }
+
+    *min = vec4_new(w, h, 0.f);
+    *max = vec4_new(0.f, 0.f, 0.f);
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        vec4_t corner   = vec4_new(c_v.x + (i & 1 ? r : -r),
+                                   c_v.y + (i & 2 ? r : -r),
+                                   c_v.z + (i & 4 ? r : -r));
+        corner          = mat_mul_vec(P, corner);
+        corner          = vec4_scale(corner, 1.f / corner.w);
+
+        // viewport transform, y = 0 is the top row
+        float x         = (corner.x + 1.f) * w * 0.5f;
+        float y         = (1.f - corner.y) * h * 0.5f;
+
+        min->x          = f_min(min->x, x);
+        min->y          = f_min(min->y, y);
+        max->x          = f_max(max->x, x);
+        max->y          = f_max(max->y, y);
+    }
+
+    min->x = f_max(min->x, 0.f);
+    min->y = f_max(min->y, 0.f);
+    max->x = f_min(max->x, w);
+    max->y = f_min(max->y, h);
+
+    return min->x < max->x && min->y < max->y;
+}
+
+/********************/
+/* public functions */
+/********************/
+
+light_t light_new_directional(vec4_t direction, vec4_t color, float intensity)
+{
+    light_t light       = { 0 };
+    light.type          = DIRECTIONAL_LIGHT;
+    light.direction_w   = vec4_normalize(direction);
+    light.color         = color;
+    light.intensity     = intensity;
+
+    return light;
+}
+
+light_t light_new_point(vec4_t position, vec4_t color, float intensity, float range)
+{
+    light_t light       = { 0 };
+    light.type          = POINT_LIGHT;
+    light.position_w    = position;
+    light.color         = color;
+    light.intensity     = intensity;
+    light.range         = range;
+
+    return light;
+}
+
+light_t light_new_spot(vec4_t position,
+                       vec4_t direction,
+                       vec4_t color,
+                       float intensity,
+                       float range,
+                       float inner_angle,
+                       float outer_angle)
+{
+    light_t light       = light_new_point(position, color, intensity, range);
+    light.type          = SPOT_LIGHT;
+    light.direction_w   = vec4_normalize(direction);
+    light.inner_cos     = f_cos(inner_angle);
+    light.outer_cos     = f_cos(outer_angle);
+
+    return light;
+}
+
+light_grid_t* light_grid_new(uint32_t width, uint32_t height)
+{
+    assert(width > 0 && height > 0);
+
+    light_grid_t* grid  = malloc(sizeof(light_grid_t));
+    grid->width         = width;
+    grid->height        = height;
+    grid->tiles_x       = (width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    grid->tiles_y       = (height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    grid->tiles         = malloc(sizeof(light_tile_t) * grid->tiles_x * grid->tiles_y);
+
+    light_grid_clear(grid);
+
+    return grid;
+}
+
+void light_grid_build(light_grid_t* grid, const light_t* lights, uint32_t size, camera_t* cam)
+{
+    assert(size <= MAX_LIGHTS);
+
+    float w     = (float)grid->width;
+    float h     = (float)grid->height;
+    mat_t V     = camera_view_mat(cam);
+    mat_t P     = camera_proj_mat(cam);
+    vec4_t min;
+    vec4_t max;
+
+    light_grid_clear(grid);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (!light_screen_bounds(&lights[i], V, P, cam, w, h, &min, &max))
+        {
+            continue;
+        }
+
+        uint32_t min_tx = (uint32_t)min.x / LIGHT_TILE_SIZE;
+        uint32_t min_ty = (uint32_t)min.y / LIGHT_TILE_SIZE;
+        uint32_t max_tx = u_min((uint32_t)max.x / LIGHT_TILE_SIZE, grid->tiles_x - 1);
+        uint32_t max_ty = u_min((uint32_t)max.y / LIGHT_TILE_SIZE, grid->tiles_y - 1);
+
+        light_grid_append(grid, i, min_tx, min_ty, max_tx, max_ty);
+    }
+}
+
+const light_tile_t* light_grid_get(const light_grid_t* grid, uint32_t x, uint32_t y)
+{
+    return &grid->tiles[(y / LIGHT_TILE_SIZE) * grid->tiles_x + x / LIGHT_TILE_SIZE];
+}
+
+void light_grid_free(light_grid_t* grid)
+{
+    free(grid->tiles);
+    free(grid);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "math.h"
+#include "camera.h"
+
+#define MAX_LIGHTS              64
+#define MAX_LIGHTS_PER_TILE     MAX_LIGHTS  // every light fits in a tile, none is dropped
+#define LIGHT_TILE_SIZE         32
+
+typedef enum
+{
+    DIRECTIONAL_LIGHT = 0,
+    POINT_LIGHT,
+    SPOT_LIGHT
+} light_type_e;
+
+typedef struct
+{
+    light_type_e    type;
+    vec4_t          position_w;
+    vec4_t          direction_w;    // direction in which the light travels
+    vec4_t          color;          // BGR
+    float           intensity;
+    float           range;          // <= 0 means infinite
+    float           inner_cos;
+    float           outer_cos;
+
+} light_t;
+
+typedef struct
+{
+    uint32_t        size;
+    uint8_t         indices[MAX_LIGHTS_PER_TILE];
+
+} light_tile_t;
+
+typedef struct
+{
+    uint32_t        width;
+    uint32_t        height;
+    uint32_t        tiles_x;
+    uint32_t        tiles_y;
+    light_tile_t*   tiles;
+
+} light_grid_t;
+
+light_t             light_new_directional(vec4_t direction, vec4_t color, float intensity);
+light_t             light_new_point(vec4_t position, vec4_t color, float intensity, float range);
+light_t             light_new_spot(vec4_t position,
+                                   vec4_t direction,
+                                   vec4_t color,
+                                   float intensity,
+                                   float range,
+                                   float inner_angle,
+                                   float outer_angle);
+
+light_grid_t*       light_grid_new(uint32_t width, uint32_t height);
+void                light_grid_build(light_grid_t* grid, const light_t* lights, uint32_t size, camera_t* cam);
+const light_tile_t* light_grid_get(const light_grid_t* grid, uint32_t x, uint32_t y);
+void                light_grid_free(light_grid_t* grid);
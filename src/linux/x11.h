@@ -0,0 +1,36 @@
+#pragma once
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../display.h"
+
+typedef struct
+{
+    XImage*         ximage;
+    XShmSegmentInfo shm_info;
+    bool            attached;           // the server mapped the segment
+    bool            pending;            // the server may still be reading the segment
+    framebuffer_t*  framebuffer;        // wraps the image memory, frames are rendered straight into it
+
+} x11_buffer_t;
+
+typedef struct
+{
+    Display*        display;
+    Window          window;
+    int             screen;
+
+    // MIT-SHM presentation, see x11_display.c
+    bool            shm;
+    Display*        present_display;    // second connection, used by the presenter thread only
+    GC              present_gc;
+
+    x11_buffer_t    buffers[DISPLAY_BUFFERS];
+
+} x11_display_t;
+
+void    x11_init(display_t* dsp, uint32_t width, uint32_t height);
+input_t x11_input(display_t* dsp);
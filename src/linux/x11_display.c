@@ -0,0 +1,463 @@
+#include "x11.h"
+
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xutil.h>
+
+#include "../rasterizer_constants.h"
+#include "../settings.h"
+
+/********************
+ *  Notes
+ *
+ * XPutImage sends the whole image through the X socket every frame. When the server supports MIT-SHM and shares
+ * memory with us (not on remote displays), the image lives in a shared memory segment instead and XShmPutImage
+ * only sends the request. The server reads the segment after the call returns, so the next frame waits for its
+ * ShmCompletion event before writing to it again.
+ *
+ * Presentation uses a second connection to the server. Input drains every event of the main connection, on the
+ * second one the completion events are the only thing in the queue. It also lets the presenter thread draw and
+ * wait without locking the connection the main thread reads input from, Xlib connections are not thread safe.
+ * Window ids are global, so both connections draw to the same window. Anything failing on the way falls back to
+ * XPutImage on the second connection.
+ *
+ * The window can be resized. Input reports the new size from ConfigureNotify, the renderer waits until the
+ * presenter is idle and display_resize recreates the images, nothing is reading or drawing them in between.
+ *
+ * This is the X11 backend of display.c, builds made with HEADLESS=1 leave out linux/ and the X libraries.
+ *
+ * - MIT-SHM    - https://www.x.org/releases/X11R7.7/doc/xextproto/shm.html
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+/********************/
+/* static variables */
+/********************/
+
+static bool shm_failed = false;
+
+/********************/
+/* static functions */
+/********************/
+
+static int shm_error_handler(Display* display, XErrorEvent* error)
+{
+    // XShmAttach fails with BadAccess when the server cannot map our segment
+    (void)display;
+    (void)error;
+
+    shm_failed = true;
+
+    return 0;
+}
+
+static Bool is_shm_completion(Display* display, XEvent* event, XPointer arg)
+{
+    // completion of the segment passed in
+    const XShmSegmentInfo* info = (const XShmSegmentInfo*)arg;
+
+    return event->type == XShmGetEventBase(display) + ShmCompletion &&
+           ((XShmCompletionEvent*)event)->shmseg == info->shmseg;
+}
+
+static int host_byte_order()
+{
+    // pixels are written as native 32 bit words
+    const uint32_t word = 1;
+
+    return *(const unsigned char*)&word == 1 ? LSBFirst : MSBFirst;
+}
+
+static x11_buffer_t* find_buffer(x11_display_t* x11, const framebuffer_t* framebuffer)
+{
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        if (x11->buffers[i].framebuffer == framebuffer)
+        {
+            return &x11->buffers[i];
+        }
+    }
+
+    // only the framebuffers handed out by the display can be presented
+    assert(false);
+
+    return NULL;
+}
+
+static bool shm_buffer_init(x11_display_t* x11, x11_buffer_t* buffer, uint32_t width, uint32_t height)
+{
+    Display* display        = x11->present_display;
+    int screen              = XDefaultScreen(display);
+
+    buffer->ximage = XShmCreateImage(display,
+                                     XDefaultVisual(display, screen),
+                                     (uint32_t)XDefaultDepth(display, screen),
+                                     ZPixmap,
+                                     NULL,
+                                     &buffer->shm_info,
+                                     width,
+                                     height);
+
+    // the framebuffer writes native 0xAARRGGBB pixels, rows may be padded
+    if (!buffer->ximage || buffer->ximage->bits_per_pixel != 8 * RGB_CHANNELS ||
+        buffer->ximage->byte_order != host_byte_order() || buffer->ximage->bytes_per_line % RGB_CHANNELS != 0)
+    {
+        return false;
+    }
+
+    uint32_t stride         = (uint32_t)buffer->ximage->bytes_per_line;
+    buffer->shm_info.shmid  = shmget(IPC_PRIVATE, stride * height, IPC_CREAT | 0600);
+
+    if (buffer->shm_info.shmid < 0)
+    {
+        return false;
+    }
+
+    buffer->shm_info.shmaddr    = shmat(buffer->shm_info.shmid, NULL, 0);
+    buffer->shm_info.readOnly   = False;
+
+    if (buffer->shm_info.shmaddr == (char*)-1)
+    {
+        buffer->shm_info.shmaddr = NULL;
+        shmctl(buffer->shm_info.shmid, IPC_RMID, NULL);
+        return false;
+    }
+
+    buffer->ximage->data    = buffer->shm_info.shmaddr;
+    buffer->framebuffer     = framebuffer_wrap(width, height, stride / RGB_CHANNELS, (uint32_t*)buffer->shm_info.shmaddr);
+
+    // errors arrive asynchronously, sync to see whether the server could attach
+    int (*handler)(Display*, XErrorEvent*) = XSetErrorHandler(shm_error_handler);
+    shm_failed              = false;
+    Status attached         = XShmAttach(display, &buffer->shm_info);
+    XSync(display, False);
+    XSetErrorHandler(handler);
+
+    // removed once both sides detach
+    shmctl(buffer->shm_info.shmid, IPC_RMID, NULL);
+
+    buffer->attached        = attached && !shm_failed;
+
+    return buffer->attached;
+}
+
+static bool shm_init(x11_display_t* x11, uint32_t width, uint32_t height)
+{
+    if (!XShmQueryExtension(x11->present_display))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        if (!shm_buffer_init(x11, &x11->buffers[i], width, height))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void shm_free(x11_display_t* x11)
+{
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        x11_buffer_t* buffer = &x11->buffers[i];
+
+        if (buffer->attached)
+        {
+            XShmDetach(x11->present_display, &buffer->shm_info);
+        }
+
+        if (buffer->ximage)
+        {
+            buffer->ximage->data = NULL;
+            XDestroyImage(buffer->ximage);
+        }
+
+        if (buffer->framebuffer)
+        {
+            framebuffer_free(buffer->framebuffer);
+        }
+
+        XSync(x11->present_display, False);
+
+        if (buffer->shm_info.shmaddr)
+        {
+            shmdt(buffer->shm_info.shmaddr);
+        }
+
+        *buffer = (x11_buffer_t){ 0 };
+    }
+}
+
+static void ximage_init(x11_display_t* x11, uint32_t width, uint32_t height)
+{
+    int screen = XDefaultScreen(x11->present_display);
+
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        x11_buffer_t* buffer = &x11->buffers[i];
+        uint32_t* data = malloc(sizeof(uint32_t) * width * height);
+
+        buffer->ximage = XCreateImage(x11->present_display,
+                                      XDefaultVisual(x11->present_display, screen),
+                                      (uint32_t)XDefaultDepth(x11->present_display, screen),
+                                      ZPixmap,
+                                      0,
+                                      (char*)data,
+                                      width,
+                                      height,
+                                      8 * RGB_CHANNELS,
+                                      0);
+
+        // Xlib swaps the bytes on the way if the server's order differs
+        buffer->ximage->byte_order = host_byte_order();
+        buffer->framebuffer = framebuffer_wrap(width,
+                                               height,
+                                               (uint32_t)buffer->ximage->bytes_per_line / RGB_CHANNELS,
+                                               data);
+    }
+}
+
+static void ximage_free(x11_display_t* x11)
+{
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        x11_buffer_t* buffer = &x11->buffers[i];
+
+        buffer->ximage->data = NULL;
+        XDestroyImage(buffer->ximage);
+        free(buffer->framebuffer->data);
+        framebuffer_free(buffer->framebuffer);
+
+        *buffer = (x11_buffer_t){ 0 };
+    }
+}
+
+static void images_init(display_t* dsp, uint32_t width, uint32_t height)
+{
+    // images in shared memory, or regular ones that are sent through the socket
+    x11_display_t* x11  = dsp->data;
+    dsp->width          = width;
+    dsp->height         = height;
+    x11->shm            = shm_init(x11, width, height);
+
+    if (!x11->shm)
+    {
+        shm_free(x11);
+        ximage_init(x11, width, height);
+    }
+
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        dsp->framebuffers[i] = x11->buffers[i].framebuffer;
+    }
+}
+
+static void images_free(display_t* dsp)
+{
+    x11_display_t* x11 = dsp->data;
+
+    if (x11->shm)
+    {
+        shm_free(x11);
+    }
+    else
+    {
+        ximage_free(x11);
+    }
+
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        dsp->framebuffers[i] = NULL;
+    }
+}
+
+static void x11_resize(display_t* dsp, uint32_t width, uint32_t height)
+{
+    x11_display_t* x11 = dsp->data;
+
+    // the server finished reading every image, display_wait ran for each one drawn
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        assert(!x11->buffers[i].pending);
+    }
+
+    images_free(dsp);
+    images_init(dsp, width, height);
+}
+
+static void x11_wait(display_t* dsp, const framebuffer_t* framebuffer)
+{
+    // the server reads the segment until it reports completion
+    x11_display_t* x11      = dsp->data;
+    x11_buffer_t* buffer    = find_buffer(x11, framebuffer);
+
+    if (buffer->pending)
+    {
+        XEvent event;
+        XIfEvent(x11->present_display, &event, is_shm_completion, (XPointer)&buffer->shm_info);
+        buffer->pending = false;
+    }
+}
+
+static void x11_draw(display_t* dsp, const framebuffer_t* framebuffer)
+{
+    // frames are rendered into the image memory, nothing is copied here
+    x11_display_t* x11      = dsp->data;
+    x11_buffer_t* buffer    = find_buffer(x11, framebuffer);
+
+    if (x11->shm)
+    {
+        XShmPutImage(x11->present_display,
+                     x11->window,
+                     x11->present_gc,
+                     buffer->ximage,
+                     0,
+                     0,
+                     0,
+                     0,
+                     framebuffer->width,
+                     framebuffer->height,
+                     True);
+
+        XFlush(x11->present_display);
+        buffer->pending = true;
+
+        return;
+    }
+
+    /* show image on display, the request is written out before returning */
+    XPutImage(x11->present_display,
+              x11->window,
+              x11->present_gc,
+              buffer->ximage,
+              0,
+              0,
+              0,
+              0,
+              framebuffer->width,
+              framebuffer->height);
+
+    XFlush(x11->present_display);
+}
+
+static void x11_clear(display_t* dsp)
+{
+    x11_display_t* x11 = dsp->data;
+
+    XClearArea(x11->display, x11->window, 0, 0, 1, 1, true);
+    XFlush(x11->display);
+}
+
+static void x11_free(display_t* dsp)
+{
+    x11_display_t* x11 = dsp->data;
+
+    XUnmapWindow(x11->display, x11->window);
+
+    images_free(dsp);
+
+    XFreeGC(x11->present_display, x11->present_gc);
+    XCloseDisplay(x11->present_display);
+    XCloseDisplay(x11->display);
+    free(x11);
+    dsp->data = NULL;
+}
+
+static const display_backend_t x11_backend =
+{
+    .resize = x11_resize,
+    .wait   = x11_wait,
+    .draw   = x11_draw,
+    .clear  = x11_clear,
+    .input  = x11_input,
+    .free   = x11_free
+};
+
+/********************/
+/* public functions */
+/********************/
+
+void x11_init(display_t* dsp, uint32_t width, uint32_t height)
+{
+
+    /*
+     * full documentation on xlib here
+     * https://www.x.org/releases/X11R7.7/doc/libX11/libX11/libX11.html
+     */
+
+    x11_display_t* x11  = calloc(1, sizeof(x11_display_t));
+    dsp->backend        = &x11_backend;
+    dsp->data           = x11;
+
+    /*
+     * The XOpenDisplay function returns a Display structure that serves as the connection to the X server and 
+     * that contains all the information about that X server. XOpenDisplay connects your application to the X server 
+     * through TCP or DECnet communications protocols, or through some local inter-process communication protocol. 
+     */
+    x11->display = XOpenDisplay(NULL);
+    assert(x11->display != NULL);
+
+    /* get screen number */
+    x11->screen = XDefaultScreen(x11->display);
+
+    /*
+     * The XCreateSimpleWindow function creates an unmapped InputOutput subwindow for a specified parent window, 
+     * returns the window ID of the created window
+     */
+    x11->window = XCreateSimpleWindow(x11->display,
+                                      XRootWindow(x11->display, x11->screen),
+                                      0,
+                                      0,
+                                      width,
+                                      height,
+                                      0,
+                                      XWhitePixel(x11->display, x11->screen),
+                                      XBlackPixel(x11->display, x11->screen));
+
+    /* configure the window */
+    XSizeHints* config = XAllocSizeHints();
+    config->flags = PMinSize;
+    config->min_width = MIN_WINDOW_SIZE;
+    config->min_height = MIN_WINDOW_SIZE;
+    XSetWMNormalHints(x11->display, x11->window, config);
+    XFree(config);
+
+    /* the window has to exist on the server before the second connection refers to it */
+    XSync(x11->display, False);
+
+    x11->present_display = XOpenDisplay(NULL);
+    assert(x11->present_display != NULL);
+
+    x11->present_gc = XCreateGC(x11->present_display, x11->window, 0, NULL);
+
+    images_init(dsp, width, height);
+
+    /* event subscription */
+    long key_mask = ExposureMask | \
+                    KeyReleaseMask | \
+                    KeyPressMask | \
+                    ButtonReleaseMask | \
+                    ButtonPressMask | \
+                    PointerMotionMask | \
+                    StructureNotifyMask;
+    XSelectInput(x11->display, x11->window, key_mask);
+
+    /*
+     * The XMapWindow function maps the window and all of its subwindows that have had map requests.
+     * If the window is an InputOutput window, XMapWindow generates Expose events on each InputOutput 
+     * window that it causes to be displayed
+     */
+    XMapWindow(x11->display, x11->window);
+    XFlush(x11->display);
+}
@@ -1,4 +1,4 @@
-#include "input.h"
+#include "x11.h"
 
 #include <math.h>
 #include <stdbool.h>
@@ -78,6 +78,13 @@ static void handle_mouse_buttons()
     }
 }
 
+static void handle_configure(input_t* input)
+{
+    // also sent when the window only moved, the renderer compares the size
+    input->width    = (uint32_t)event.xconfigure.width;
+    input->height   = (uint32_t)event.xconfigure.height;
+}
+
 static void handle_keyboard()
 {
     int32_t type = event.type;
@@ -88,12 +95,16 @@ static void handle_keyboard()
         if      (button == X_ESCAPE)    { keys |= QUIT;     }
         else if (button == X_1)         { keys |= KEY_1;    }
         else if (button == X_2)         { keys |= KEY_2;    }
+        else if (button == X_3)         { keys |= KEY_3;    }
+        else if (button == X_4)         { keys |= KEY_4;    }
     }
     else if (type == KeyRelease)
     {
         if      (button == X_ESCAPE)    { keys ^= QUIT;     }
         else if (button == X_1)         { keys ^= KEY_1;    }
         else if (button == X_2)         { keys ^= KEY_2;    }
+        else if (button == X_3)         { keys ^= KEY_3;    }
+        else if (button == X_4)         { keys ^= KEY_4;    }
     }
 }
 
@@ -101,25 +112,28 @@ static void handle_keyboard()
 /* public functions */
 /********************/
 
-input_t handle_input(display_t* dsp)
+input_t x11_input(display_t* dsp)
 {
+    x11_display_t* x11 = dsp->data;
+
     keys            = keys & ~((uint64_t)(SCROLL_UP | SCROLL_DOWN));
     input_t input   = { 0 };
 
-    XPeekEvent(dsp->display, &event);
+    XPeekEvent(x11->display, &event);
 
     while (event.type != Expose)
     {
         if      (event.type == KeyPress || event.type == KeyRelease)        { handle_keyboard(); }
         else if (event.type == MotionNotify)                                { handle_mouse_motion(&input); }
         else if (event.type == ButtonPress || event.type == ButtonRelease)  { handle_mouse_buttons(); }
+        else if (event.type == ConfigureNotify)                             { handle_configure(&input); }
 
-        XNextEvent(dsp->display, &event);
-        XPeekEvent(dsp->display, &event);
+        XNextEvent(x11->display, &event);
+        XPeekEvent(x11->display, &event);
     }
 
     // pop Expose event
-    XNextEvent(dsp->display, &event);
+    XNextEvent(x11->display, &event);
 
     input.keys = keys;
 
@@ -1,18 +1,136 @@
 #include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "renderer.h"
 #include "rasterizer.h"
 #include "time_utils.h"
+#include "settings.h"
 
-int32_t main()
+/*
+ * renderer [options] [width height [render scale | dynamic [min max]]]
+ *
+ * dynamic moves the render scale between min and max, 0.5 and 1 by default, starting from max.
+ *
+ *  -H          headless, no window or X server, see headless.c (always on in make HEADLESS=1 builds)
+ *  -n frames   frames a headless run renders, 0 until the script quits
+ *  -i file     input script of a headless run, see input_script.c
+ *  -o dir      write every presented frame to dir as ppm
+ *  -s file     glb scene
+ *  -e file     environment map, ambient term only without one
+ *  -T          tiled texture layout, linear by default
+ *  -c          block compress textures at load
+ *  -S          stream fine texture mips in the background
+ *  -b MiB      byte budget of streamed texture mips, 1-4095
+ *  -a          pack small textures into atlas pages
+ *  -f frames   frames in flight, 2 (double buffered) or 3 (triple buffered)
+ *  -F          tiled colour and depth buffers, detiled on present
+ *  -d bits     depth buffer format, 32 (float), 24 or 16 (unorm)
+ *  -A probes   most trilinear probes of anisotropic filtering, 2-16, 8 by default
+ */
+int32_t main(int32_t argc, char** argv)
 {
     const char* scene   = "/home/martin/Documents/Projects/pbr-software-renderer/assets/waterbottle.glb";
+    const char* env     = NULL;
+    int32_t option      = 0;
+    int32_t bits        = 0;
+    unsigned long mib   = 0;
+    char* end           = NULL;
+
+    while ((option = getopt(argc, argv, "Hn:i:o:s:e:TcSb:af:Fd:A:")) != -1)
+    {
+        switch (option)
+        {
+            case 'H':
+                change_headless();
+                break;
+            case 'n':
+                set_headless_frames((uint32_t)atoi(optarg));
+                break;
+            case 'i':
+                set_input_script(optarg);
+                break;
+            case 'o':
+                set_frame_dump(optarg);
+                break;
+            case 's':
+                scene = optarg;
+                break;
+            case 'e':
+                env = optarg;
+                break;
+            case 'T':
+                change_texture_tiling();
+                break;
+            case 'c':
+                change_texture_compression();
+                break;
+            case 'S':
+                change_texture_streaming();
+                break;
+            case 'b':
+                // the budget is a uint32_t byte count, negative numbers would wrap in strtoul
+                mib = strtoul(optarg, &end, 10);
+                if (optarg[0] == '-' || *end != '\0' || mib == 0 || mib > (UINT32_MAX >> 20))
+                {
+                    printf("invalid texture budget: %s, expected 1-%u MiB\n", optarg, UINT32_MAX >> 20);
+                    return 1;
+                }
+                set_texture_budget((uint32_t)mib << 20);
+                break;
+            case 'a':
+                change_texture_atlas();
+                break;
+            case 'f':
+                set_frames_in_flight((uint32_t)atoi(optarg));
+                break;
+            case 'F':
+                change_framebuffer_tiling();
+                break;
+            case 'd':
+                bits = atoi(optarg);
+                set_depth_format(bits == 16 ? DEPTH_FORMAT_U16 : (bits == 24 ? DEPTH_FORMAT_U24 : DEPTH_FORMAT_F32));
+                break;
+            case 'A':
+                set_max_anisotropy((uint32_t)atoi(optarg));
+                break;
+            default:
+                return 1;
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc >= 2)
+    {
+        set_window_size((uint32_t)atoi(argv[0]), (uint32_t)atoi(argv[1]));
+    }
+    if (argc >= 3 && strcmp(argv[2], "dynamic") == 0)
+    {
+        change_dynamic_resolution();
+
+        if (argc >= 5)
+        {
+            set_dynamic_scale_bounds(strtof(argv[3], NULL), strtof(argv[4], NULL));
+            set_render_scale(get_max_dynamic_scale());
+        }
+    }
+    else if (argc >= 3)
+    {
+        set_render_scale(strtof(argv[2], NULL));
+    }
 
     // initialize
     time_init();
     renderer_init();
     renderer_load(scene);
+    if (env)
+    {
+        renderer_load_environment(env);
+    }
 
     // run
     renderer_run();
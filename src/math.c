@@ -197,19 +197,19 @@ vec4_t vec4_new(float x, float y, float z)
 vec4_t vec4_from_bgra(uint32_t c)
 {
     float d = 1.f / 255.f;
-    float b = (float)((c >> 24) & 0xFF);
-    float g = (float)((c >> 16) & 0xFF);
-    float r = (float)((c >>  8) & 0xFF);
+    float b = (float)((c >>  0) & 0xFF);
+    float g = (float)((c >>  8) & 0xFF);
+    float r = (float)((c >> 16) & 0xFF);
 
     return vec4_new(b * d, g * d, r * d);;
 }
 
 uint32_t vec4_to_bgra(vec4_t c)
 {
-    uint32_t b = ((uint32_t)(f_min(f_max(c.x, 0.f), 1.f) * 255)) << 24;
-    uint32_t g = ((uint32_t)(f_min(f_max(c.y, 0.f), 1.f) * 255)) << 16;
-    uint32_t r = ((uint32_t)(f_min(f_max(c.z, 0.f), 1.f) * 255)) <<  8;
-    // uint32_t a = ((uint32_t)(f_min(f_max(c.w, 0.f), 1.f) * 255)) <<  0;
+    uint32_t b = ((uint32_t)(f_min(f_max(c.x, 0.f), 1.f) * 255)) <<  0;
+    uint32_t g = ((uint32_t)(f_min(f_max(c.y, 0.f), 1.f) * 255)) <<  8;
+    uint32_t r = ((uint32_t)(f_min(f_max(c.z, 0.f), 1.f) * 255)) << 16;
+    // uint32_t a = ((uint32_t)(f_min(f_max(c.w, 0.f), 1.f) * 255)) << 24;
 
     return b + g + r;
 }
@@ -517,6 +517,38 @@ void mat_print(mat_t m)
     printf("|%.3f, %.3f, %.3f, %.3f|\n", m.data[3][0], m.data[3][1], m.data[3][2], m.data[3][3]);
 }
 
+/*
+ * Quaternion
+ */
+
+quat_t quat_identity()
+{
+    return quat_new(0.f, 0.f, 0.f, 1.f);
+}
+
+quat_t quat_new(float x, float y, float z, float w)
+{
+    quat_t q;
+    q.x = x;
+    q.y = y;
+    q.z = z;
+    q.w = w;
+    return q;
+}
+
+vec4_t quat_rotate(quat_t q, vec4_t v)
+{
+    // v' = v + 2w(u x v) + 2u x (u x v)
+    vec4_t u    = vec4_new(q.x, q.y, q.z);
+    vec4_t uv   = vec4_cross(u, v);
+    vec4_t uuv  = vec4_cross(u, uv);
+    vec4_t r    = vec4_add(v, vec4_scale(uv, 2.f * q.w));
+    r           = vec4_add(r, vec4_scale(uuv, 2.f));
+    r.w         = v.w;
+
+    return r;
+}
+
 mat_t x_axis_rotation(float rad)
 {
     float sin_val   = sinf(rad);
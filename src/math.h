@@ -126,6 +126,7 @@ typedef struct
 
 quat_t quat_identity();
 quat_t quat_new(float x, float y, float z, float w);
+vec4_t quat_rotate(quat_t q, vec4_t v);
 
 
 /********************/
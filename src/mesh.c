@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "texture_manager.h"
+
 mesh_t* mesh_new(char*      name,
                  vec4_t*    vertices,
                  vec2_t*    texcoords,
@@ -47,9 +49,9 @@ void mesh_free(mesh_t* mesh)
     free(mesh->texcoords);
     free(mesh->normals);
     free(mesh->indices);
-    texture_free(mesh->albedo);
-    texture_free(mesh->metallic);
-    texture_free(mesh->normal);
-    texture_free(mesh->occlusion);
+    texture_manager_release(mesh->albedo);
+    texture_manager_release(mesh->metallic);
+    texture_manager_release(mesh->normal);
+    texture_manager_release(mesh->occlusion);
     free(mesh);
 }
\ No newline at end of file
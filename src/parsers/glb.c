@@ -4,11 +4,16 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "png.h"
 #include "json.h"
 #include "../file.h"
+#include "../settings.h"
+#include "../texture_atlas.h"
+#include "../texture_manager.h"
+#include "../texture_stream.h"
 #include "scene_validator.h"
 #include "json_scene_constants.h"
 
@@ -200,19 +205,25 @@ static sphere_t compute_bounding_sphere(vec4_t* vertices, uint32_t size)
     return result;
 }
 
+static bool string_equal(const json_node_t* node, const char* string)
+{
+    // json strings are not terminated, the whole string has to match and not just a prefix
+    return node && node->size == strlen(string) && strncmp(node->string, string, node->size) == 0;
+}
+
 static type_e parse_type(const json_node_t* node)
 {
     assert(node->type == JSON_STRING);
 
-    if (strncmp(node->string, "VEC2", node->size) == 0)
+    if (string_equal(node, "VEC2"))
     {
         return VEC_2;
     }
-    else if (strncmp(node->string, "VEC3", node->size) == 0)
+    else if (string_equal(node, "VEC3"))
     {
         return VEC_3;
     }
-    else if (strncmp(node->string, "VEC4", node->size) == 0)
+    else if (string_equal(node, "VEC4"))
     {
         return VEC_4;
     }
@@ -288,6 +299,203 @@ static view_t parse_material_texture_info(const json_t* json, const json_node_t*
     return result;
 }
 
+static texture_wrap_e parse_wrap(const json_node_t* node)
+{
+    // GL enums, REPEAT when missing
+    if (!node || node->uinteger == 10497)
+    {
+        return TEXTURE_WRAP_REPEAT;
+    }
+
+    if (node->uinteger == 33071)
+    {
+        return TEXTURE_WRAP_CLAMP;
+    }
+
+    assert(node->uinteger == 33648);
+    return TEXTURE_WRAP_MIRROR;
+}
+
+static void parse_material_sampler(const json_t* json, const json_node_t* node, texture_wrap_e* wrap_s, texture_wrap_e* wrap_t)
+{
+    // textures optionally point to a sampler, REPEAT without one
+    const json_node_t* textures  = json_find_node(json, 1, JSON_TEXTURES);
+    const json_node_t* samplers  = json_find_node(json, 1, JSON_SAMPLERS);
+
+    const json_node_t* index     = json_find_child(node, JSON_INDEX);
+    const json_node_t* tex       = json_find_index(textures, index->uinteger);
+
+    index                        = json_find_child(tex, JSON_SAMPLER);
+    const json_node_t* sampler   = index && samplers ? json_find_index(samplers, index->uinteger) : NULL;
+
+    *wrap_s                      = parse_wrap(json_find_child(sampler, JSON_WRAP_S));
+    *wrap_t                      = parse_wrap(json_find_child(sampler, JSON_WRAP_T));
+}
+
+static float parse_float(const json_node_t* node, float fallback)
+{
+    if (!node)
+    {
+        return fallback;
+    }
+
+    if (node->type == JSON_REAL)
+    {
+        return node->real;
+    }
+
+    if (node->type == JSON_NUMBER)
+    {
+        return (float)node->integer;
+    }
+
+    return fallback;
+}
+
+static vec4_t parse_vec3(const json_node_t* node, vec4_t fallback)
+{
+    if (!node || node->size < 3)
+    {
+        return fallback;
+    }
+
+    return vec4_new(parse_float(json_find_index(node, 0), fallback.x),
+                    parse_float(json_find_index(node, 1), fallback.y),
+                    parse_float(json_find_index(node, 2), fallback.z));
+}
+
+static quat_t parse_quat(const json_node_t* node)
+{
+    if (!node || node->size < 4)
+    {
+        return quat_identity();
+    }
+
+    return quat_new(parse_float(json_find_index(node, 0), 0.f),
+                    parse_float(json_find_index(node, 1), 0.f),
+                    parse_float(json_find_index(node, 2), 0.f),
+                    parse_float(json_find_index(node, 3), 1.f));
+}
+
+static mat_t parse_node_transform(const json_node_t* node)
+{
+    // glTF nodes store either a column major matrix or translation, rotation and scale applied as T * R * S
+    const json_node_t* matrix   = json_find_child(node, JSON_MATRIX);
+
+    if (matrix && matrix->size == 16)
+    {
+        mat_t m;
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            m.data[i % 4][i / 4] = parse_float(json_find_index(matrix, i), i % 5 == 0 ? 1.f : 0.f);
+        }
+
+        return m;
+    }
+
+    vec4_t translation          = parse_vec3(json_find_child(node, JSON_TRANSLATION), vec4_new(0.f, 0.f, 0.f));
+    quat_t rotation             = parse_quat(json_find_child(node, JSON_ROTATION));
+    vec4_t scale                = parse_vec3(json_find_child(node, JSON_SCALE), vec4_from_scalar(1.f));
+
+    mat_t rs                    = mat_from_vec4(vec4_scale(quat_rotate(rotation, vec4_new(1.f, 0.f, 0.f)), scale.x),
+                                                vec4_scale(quat_rotate(rotation, vec4_new(0.f, 1.f, 0.f)), scale.y),
+                                                vec4_scale(quat_rotate(rotation, vec4_new(0.f, 0.f, 1.f)), scale.z));
+
+    return mat_mul_mat(mat_translate(translation), rs);
+}
+
+static light_t parse_light(const json_node_t* light, mat_t transform)
+{
+    // glTF lights point down -z in their local space and colors are stored as RGB
+
+    const json_node_t* type = json_find_child(light, JSON_TYPE);
+    const json_node_t* spot = json_find_child(light, JSON_SPOT);
+
+    vec4_t rgb              = parse_vec3(json_find_child(light, JSON_COLOR), vec4_from_scalar(1.f));
+    vec4_t color            = vec4_new(rgb.z, rgb.y, rgb.x);
+    float intensity         = parse_float(json_find_child(light, JSON_INTENSITY), 1.f);
+    float range             = parse_float(json_find_child(light, JSON_RANGE), 0.f);
+
+    vec4_t position         = vec4_new(transform.data[0][3], transform.data[1][3], transform.data[2][3]);
+    vec4_t direction        = vec4_new(-transform.data[0][2], -transform.data[1][2], -transform.data[2][2]);
+
+    if (string_equal(type, "directional"))
+    {
+        return light_new_directional(direction, color, intensity);
+    }
+
+    if (string_equal(type, "spot"))
+    {
+        float inner         = parse_float(json_find_child(spot, JSON_INNER_CONE), 0.f);
+        float outer         = parse_float(json_find_child(spot, JSON_OUTER_CONE), F_PI / 4.f);
+
+        return light_new_spot(position, direction, color, intensity, range, inner, outer);
+    }
+
+    return light_new_point(position, color, intensity, range);
+}
+
+static void parse_light_nodes(const json_node_t* lights,
+                              const json_node_t* nodes,
+                              const json_node_t* node_index,
+                              mat_t parent,
+                              scene_t* scene,
+                              uint32_t* dropped)
+{
+    // lights can sit anywhere in the node hierarchy and inherit the transforms of their parents
+    while (node_index)
+    {
+        const json_node_t* node     = json_find_index(nodes, node_index->uinteger);
+        const json_node_t* ext      = json_find_child(node, JSON_EXTENSIONS);
+        const json_node_t* punctual = json_find_child(ext, JSON_LIGHTS_PUNCTUAL);
+        const json_node_t* index    = json_find_child(punctual, JSON_LIGHT);
+        const json_node_t* children = json_find_child(node, JSON_CHILDREN);
+        mat_t transform             = mat_mul_mat(parent, parse_node_transform(node));
+
+        if (index && scene->lights_size < MAX_LIGHTS)
+        {
+            const json_node_t* light                = json_find_index(lights, index->uinteger);
+            scene->lights[scene->lights_size]       = parse_light(light, transform);
+            scene->lights_size++;
+        }
+        else if (index)
+        {
+            (*dropped)++;
+        }
+
+        parse_light_nodes(lights, nodes, json_find_index(children, 0), transform, scene, dropped);
+
+        node_index = node_index->next;
+    }
+}
+
+static void parse_lights(const json_t* json, scene_t* scene)
+{
+    const json_node_t* lights       = json_find_node(json, 3, JSON_EXTENSIONS, JSON_LIGHTS_PUNCTUAL, JSON_LIGHTS);
+    const json_node_t* scenes       = json_find_node(json, 1, JSON_SCENES);
+    const json_node_t* nodes        = json_find_node(json, 1, JSON_NODES);
+    const json_node_t* scene_nodes  = json_find_child(json_find_index(scenes, 0), JSON_NODES);
+    uint32_t dropped                = 0;
+
+    scene->lights_size              = 0;
+
+    parse_light_nodes(lights, nodes, json_find_index(scene_nodes, 0), mat_new_identity(), scene, &dropped);
+
+    if (dropped > 0)
+    {
+        printf("scene has %u lights, only the first %u are used\n", scene->lights_size + dropped, MAX_LIGHTS);
+    }
+
+    // scenes without lights get the default sun
+    if (scene->lights_size == 0)
+    {
+        vec4_t direction    = vec4_negate(vec4_from_scalar(1.f));
+        scene->lights[0]    = light_new_directional(direction, vec4_from_scalar(1.f), 1.f);
+        scene->lights_size  = 1;
+    }
+}
+
 static mesh_t* parse_meshes(const json_t* json, const chunk_t binary)
 {
     const json_node_t* scenes       = json_find_node(json, 1, JSON_SCENES);
@@ -298,8 +506,20 @@ static mesh_t* parse_meshes(const json_t* json, const chunk_t binary)
     const json_node_t* scene_nodes  = json_find_child(scene, JSON_NODES);
     const json_node_t* node_index   = json_find_index(scene_nodes, 0);
 
-    // get mesh
+    // get first mesh, light nodes do not have one
+    while (node_index && !json_find_child(json_find_index(nodes, node_index->uinteger), JSON_MESH))
+    {
+        node_index                  = node_index->next;
+    }
+
+    if (!node_index)
+    {
+        printf("invalid scene: no node has a mesh\n");
+        assert(false);
+    }
+
     const json_node_t* node         = json_find_index(nodes, node_index->uinteger);
+
     const json_node_t* index        = json_find_child(node, JSON_MESH);
     const json_node_t* mesh         = json_find_index(meshes, index->uinteger);
     const json_node_t* primitives   = json_find_child(mesh, JSON_PRIMITIVES);
@@ -328,24 +548,109 @@ static mesh_t* parse_meshes(const json_t* json, const chunk_t binary)
     const json_node_t* normal       = json_find_child(material, JSON_NORMAL_TEX);
     const json_node_t* occlusion    = json_find_child(material, JSON_OCCLUSION_TEX);
 
-    view_t albedo_view              = parse_material_texture_info(json, albedo, binary);
-    view_t metallic_view            = parse_material_texture_info(json, metallic, binary);
-    view_t normal_view              = parse_material_texture_info(json, normal, binary);
-    view_t occlusion_view           = parse_material_texture_info(json, occlusion, binary);
+    // textures already loaded by another material with the same sampler are shared, the rest is decoded in one batch
+    const json_node_t* tex_nodes[4] = { albedo, metallic, normal, occlusion };
+    texture_format_e formats[4]     = { TEXTURE_FORMAT_RGB16_LINEAR,
+                                        TEXTURE_FORMAT_RG8,
+                                        TEXTURE_FORMAT_XYZ8_SNORM,
+                                        TEXTURE_FORMAT_R8 };
+    texture_t* textures[4]          = { NULL };
+    texture_wrap_e wrap_s[4];
+    texture_wrap_e wrap_t[4];
+    uint64_t hashes[4];
+    uint32_t slots[4];
+    bool compress                   = get_texture_compression();
+
+    texture_batch_info_t batch_info = { 0 };
+    batch_info.compress             = compress;
+    batch_info.layout               = get_texture_tiling() ? TEXTURE_LAYOUT_TILED : TEXTURE_LAYOUT_LINEAR;
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        view_t view                 = parse_material_texture_info(json, tex_nodes[i], binary);
+        hashes[i]                   = texture_manager_hash(view.data, view.size);
+        parse_material_sampler(json, tex_nodes[i], &wrap_s[i], &wrap_t[i]);
+        textures[i]                 = texture_manager_find(hashes[i], formats[i], compress, wrap_s[i], wrap_t[i]);
+
+        if (textures[i])
+        {
+            continue;
+        }
+
+        // the same image in the same role and sampler twice is decoded once and picked up from the manager below
+        uint32_t entry              = batch_info.size;
+        uint32_t source             = entry;
+        bool duplicate              = false;
+
+        for (uint32_t j = 0; j < entry; j++)
+        {
+            uint32_t slot           = slots[j];
+            source                  = hashes[slot] == hashes[i] && source == entry ? j : source;
+            duplicate               = duplicate || (hashes[slot] == hashes[i] &&
+                                                    formats[slot] == formats[i] &&
+                                                    wrap_s[slot] == wrap_s[i] &&
+                                                    wrap_t[slot] == wrap_t[i]);
+        }
+
+        if (duplicate)
+        {
+            continue;
+        }
+
+        batch_info.buffers[entry]       = view.data;
+        batch_info.buffer_sizes[entry]  = view.size;
+        batch_info.formats[entry]       = formats[i];
+        batch_info.sources[entry]       = source;
+        slots[entry]                    = i;
+        batch_info.size++;
+    }
+
+    texture_batch_t parsed_batch        = { 0 };
+
+    if (batch_info.size > 0)
+    {
+        parsed_batch                    = parse_multiple_pngs(batch_info);
+
+        // gutters are filled once from the wrap modes of the decoded texture, a shared texture was packed by
+        // its first owner and every owner has the same wrap modes (they are part of the manager key)
+        for (uint32_t i = 0; i < batch_info.size; i++)
+        {
+            uint32_t slot               = slots[i];
+            texture_t* texture          = parsed_batch.textures[i];
+
+            texture_set_wrap(texture, wrap_s[slot], wrap_t[slot]);
+            texture_manager_add(hashes[slot], texture);
+            textures[slot]              = texture;
+
+            // small textures are packed and the rest can be streamed
+            if (get_texture_atlas() && texture_atlas_add(texture))
+            {
+                continue;
+            }
+
+            if (get_texture_streaming())
+            {
+                texture_stream_add(texture, batch_info.buffers[i], batch_info.buffer_sizes[i], TEXTURE_STREAM_RESIDENT_SIZE);
+            }
+        }
+    }
 
-    texture_batch_info_t batch_info;
-    batch_info.size = 4;
-    batch_info.buffers[0]           = albedo_view.data;
-    batch_info.buffers[1]           = metallic_view.data;
-    batch_info.buffers[2]           = normal_view.data;
-    batch_info.buffers[3]           = occlusion_view.data;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (!textures[i])
+        {
+            textures[i]                 = texture_manager_find(hashes[i], formats[i], compress, wrap_s[i], wrap_t[i]);
+        }
+    }
 
-    batch_info.buffer_sizes[0]      = albedo_view.size;
-    batch_info.buffer_sizes[1]      = metallic_view.size;
-    batch_info.buffer_sizes[2]      = normal_view.size;
-    batch_info.buffer_sizes[3]      = occlusion_view.size;
+    if (get_texture_atlas())
+    {
+        texture_atlas_stats_t stats     = texture_atlas_stats();
+        float occupancy                 = stats.page_texels ? 100.f * (float)stats.used_texels / (float)stats.page_texels : 0.f;
 
-    texture_batch_t parsed_batch    = parse_multiple_pngs(batch_info);
+        printf("atlas: %u textures in %u pages, %.1f%% occupied, %ld bytes saved\n",
+               stats.textures, stats.pages, (double)occupancy, (long)stats.bytes_saved);
+    }
 
     return mesh_new("name", 
                     vertices,
@@ -356,10 +661,10 @@ static mesh_t* parse_meshes(const json_t* json, const chunk_t binary)
                     tex_coords_view.count,
                     normals_view.count,
                     indices_view.count,
-                    parsed_batch.textures[0],
-                    parsed_batch.textures[1],
-                    parsed_batch.textures[2],
-                    parsed_batch.textures[3],
+                    textures[0],
+                    textures[1],
+                    textures[2],
+                    textures[3],
                     bounding_sphere);
 }
 
@@ -382,9 +687,9 @@ scene_t* parse_scene(const char* file_path)
     json_t* json = json_new(json_chunk.data, json_chunk.size);
     validate_glb_scene(json);
 
-    // scene->dir_light
-    // scene->point_light
     scene->mesh     = parse_meshes(json, binary);
+    parse_lights(json, scene);
+
     vec4_t target   = vec4_new(0.f, 0.f, 0.f);
     scene->camera   = camera_new(target,
                                  F_PI / 2.f,
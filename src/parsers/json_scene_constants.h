@@ -10,6 +10,10 @@
 #define JSON_MATERIALS          "materials"
 #define JSON_NODES              "nodes"
 #define JSON_TEXTURES           "textures"
+#define JSON_SAMPLERS           "samplers"
+#define JSON_SAMPLER            "sampler"
+#define JSON_WRAP_S             "wrapS"
+#define JSON_WRAP_T             "wrapT"
 #define JSON_BUFFER_VIEW        "bufferView"
 #define JSON_COMP_TYPE          "componentType"
 #define JSON_COUNT              "count"
@@ -38,4 +42,18 @@
 #define JSON_MESH               "mesh"
 #define JSON_ROTATION           "rotation"
 #define JSON_NODES              "nodes"
-#define JSON_SOURCE             "source"
\ No newline at end of file
+#define JSON_SOURCE             "source"
+#define JSON_TRANSLATION        "translation"
+#define JSON_SCALE              "scale"
+#define JSON_MATRIX             "matrix"
+#define JSON_CHILDREN           "children"
+#define JSON_EXTENSIONS         "extensions"
+#define JSON_LIGHTS_PUNCTUAL    "KHR_lights_punctual"
+#define JSON_LIGHTS             "lights"
+#define JSON_LIGHT              "light"
+#define JSON_COLOR              "color"
+#define JSON_INTENSITY          "intensity"
+#define JSON_RANGE              "range"
+#define JSON_SPOT               "spot"
+#define JSON_INNER_CONE         "innerConeAngle"
+#define JSON_OUTER_CONE         "outerConeAngle"
\ No newline at end of file
@@ -616,6 +616,23 @@ static void reset_static_data()
     memset(node_pool, 0, PNG_NODE_POOL_SIZE * sizeof(node_t));
 }
 
+static void finish_texture(texture_t* texture, texture_format_e format, bool compress, texture_layout_e layout)
+{
+    // format conversion first so albedo mips are filtered in linear space
+    texture_set_format(texture, format);
+    texture_generate_mips(texture);
+
+    // blocks are 4x4 tiles already
+    if (compress)
+    {
+        texture_compress(texture);
+    }
+    else
+    {
+        texture_set_layout(texture, layout);
+    }
+}
+
 static int32_t parse_single_png(void* data)
 {
     job_args_t* args            = (job_args_t*)data;
@@ -624,7 +641,30 @@ static int32_t parse_single_png(void* data)
 
     while (index < info.size)
     {
-        args->batch->textures[index] = parse_png(info.buffers[index], info.buffer_sizes[index]);
+        // entries sharing an image are finished by the thread that decodes it, textures are spread over the pool
+        if (info.sources[index] == index)
+        {
+            texture_t* decoded  = parse_png(info.buffers[index], info.buffer_sizes[index]);
+            uint32_t last       = index;
+
+            for (uint32_t i = index + 1; i < info.size; i++)
+            {
+                last            = info.sources[i] == index ? i : last;
+            }
+
+            for (uint32_t i = index; i <= last; i++)
+            {
+                if (info.sources[i] != index)
+                {
+                    continue;
+                }
+
+                // the last user takes the decoded texture, the others convert a copy
+                texture_t* texture = i == last ? decoded : texture_copy(decoded);
+                finish_texture(texture, info.formats[i], info.compress, info.layout);
+                args->batch->textures[i] = texture;
+            }
+        }
 
         index = (*args->index)++;
     }
@@ -656,7 +696,7 @@ texture_t* parse_png(const unsigned char* buf, uint32_t size)
 
     parse_header();
 
-    texture_t* texture = texture_new(header.width, header.height, header.stride);
+    texture_t* texture = texture_new(header.width, header.height, header.stride, TEXTURE_LAYOUT_LINEAR);
     
     dst_cursor      = 0;
     dst_size        = header.width * header.height * header.stride;
@@ -679,6 +719,14 @@ texture_t* parse_png(const unsigned char* buf, uint32_t size)
     return texture;
 }
 
+texture_t* parse_png_texture(const unsigned char* buffer, uint32_t size, texture_format_e format, bool compress, texture_layout_e layout)
+{
+    texture_t* texture = parse_png(buffer, size);
+    finish_texture(texture, format, compress, layout);
+
+    return texture;
+}
+
 texture_batch_t parse_multiple_pngs(texture_batch_info_t info)
 {
     thrd_t threads[MAX_THREAD_COUNT];
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdbool.h>
 #include "../texture.h"
 
 #define MAX_TEXTURE_LOAD_COUNT 10
@@ -16,7 +17,12 @@ typedef struct
     uint32_t             size;
     uint32_t             buffer_sizes[MAX_TEXTURE_LOAD_COUNT];
     const unsigned char* buffers[MAX_TEXTURE_LOAD_COUNT];
+    texture_format_e     formats[MAX_TEXTURE_LOAD_COUNT];
+    uint32_t             sources[MAX_TEXTURE_LOAD_COUNT];   // first entry with the same image, decoded only once
+    bool                 compress;      // block compress, blocks are 4x4 tiles already
+    texture_layout_e     layout;        // of uncompressed textures
 } texture_batch_info_t;
 
 texture_t*      parse_png(const unsigned char* buffer, uint32_t size);
+texture_t*      parse_png_texture(const unsigned char* buffer, uint32_t size, texture_format_e format, bool compress, texture_layout_e layout);
 texture_batch_t parse_multiple_pngs(texture_batch_info_t info);
\ No newline at end of file
@@ -62,13 +62,36 @@ static void validate_nodes(json_t* json)
 
     const json_node_t* current = json_find_index(nodes, 0);
     uint32_t mesh_count = 0;
+    uint32_t light_count = 0;
+    bool has_lights = false;
     
     while(current)
     {
         assert_container(current, 2, "nodes->node");
 
+        /* node is either a mesh, a KHR_lights_punctual light or a group that only transforms its children */
         const json_node_t* mesh = json_find_child(current, JSON_MESH);
-        mesh_count = assert_index(mesh, mesh_count, JSON_MESH);
+        const json_node_t* extensions = json_find_child(current, JSON_EXTENSIONS);
+        const json_node_t* punctual = json_find_child(extensions, JSON_LIGHTS_PUNCTUAL);
+        const json_node_t* light = json_find_child(punctual, JSON_LIGHT);
+        const json_node_t* children = json_find_child(current, JSON_CHILDREN);
+        if (mesh)
+        {
+            mesh_count = assert_index(mesh, mesh_count, JSON_MESH);
+        }
+        else if (light || !children)
+        {
+            light_count = assert_index(light, light_count, JSON_LIGHT);
+            has_lights = true;
+        }
+
+        /* children point at other nodes */
+        const json_node_t* child = json_find_index(children, 0);
+        while (child)
+        {
+            assert(child->uinteger < nodes->size);
+            child = child->next;
+        }
 
         const json_node_t* name = json_find_child(current, JSON_NAME);
         assert(name);
@@ -79,6 +102,33 @@ static void validate_nodes(json_t* json)
     /* validate number of mesh nodes */
     const json_node_t* meshes = json_find_node(json, 1, JSON_MESHES);
     assert_container(meshes, mesh_count + 1, JSON_MESHES);
+
+    /* validate number of lights */
+    if (has_lights)
+    {
+        const json_node_t* lights = json_find_node(json, 3, JSON_EXTENSIONS, JSON_LIGHTS_PUNCTUAL, JSON_LIGHTS);
+        assert_container(lights, light_count + 1, JSON_LIGHTS);
+    }
+}
+
+static void validate_lights(json_t* json)
+{
+    const json_node_t* lights = json_find_node(json, 3, JSON_EXTENSIONS, JSON_LIGHTS_PUNCTUAL, JSON_LIGHTS);
+    const json_node_t* light = json_find_index(lights, 0);
+
+    while (light)
+    {
+        const json_node_t* type = json_find_child(light, JSON_TYPE);
+        assert(type && type->type == JSON_STRING);
+
+        if (strncmp(type->string, "spot", (uint64_t)type->size) == 0)
+        {
+            const json_node_t* spot = json_find_child(light, JSON_SPOT);
+            assert(spot);
+        }
+
+        light = light->next;
+    }
 }
 
 static void validate_meshes(json_t* json)
@@ -268,6 +318,7 @@ void validate_glb_scene(json_t* json)
     validate_textures(json);
     validate_images(json);
     validate_buffer_views(json);
+    validate_lights(json);
 
     // TODO: add type validation  (VEC/SCALAR etc) to accessor validation
 }
\ No newline at end of file
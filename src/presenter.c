@@ -0,0 +1,239 @@
+#include "presenter.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "time_utils.h"
+
+/********************
+ *  Notes
+ *
+ * The presenter thread shows finished frames while the renderer works on the next one. Framebuffers circulate
+ * between two queues, the renderer takes one from the free queue, renders and submits it to the present queue,
+ * the presenter draws it, waits until the server is done reading and hands it back. The number of framebuffers
+ * in circulation bounds how far the renderer can run ahead, two overlap one frame of rendering with one of
+ * presenting, three let the renderer start another frame while the presenter still waits on the server.
+ *
+ * Tiled render targets and targets smaller than the window are owned by the presenter, one per display image. The
+ * presenter detiles or upscales a frame into its image right before drawing it, the renderer never touches the
+ * images then. Otherwise frames are rendered straight into the images. The presenter lives as long as the
+ * window size, so the upscale table is built once with it.
+ *
+ * Waits are short and rare, both sides poll the queues and sleep in between instead of blocking on a condition.
+ * Latency is measured from submit until the server finished reading the frame.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define PRESENTER_POLL (50 * MICROSECOND)
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static void poll_wait()
+{
+    struct timespec duration = { 0, PRESENTER_POLL };
+    thrd_sleep(&duration, NULL);
+}
+
+static framebuffer_t* display_image(presenter_t* presenter, const framebuffer_t* target)
+{
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS; i++)
+    {
+        if (presenter->targets[i] == target)
+        {
+            return display_framebuffer(presenter->display, i);
+        }
+    }
+
+    // only targets handed out by acquire can be submitted
+    assert(false);
+
+    return NULL;
+}
+
+static int32_t present_frames(void* data)
+{
+    presenter_t* presenter = data;
+    frame_t frame;
+
+    while (true)
+    {
+        // frames submitted before quit are still presented
+        bool quit = atomic_load_explicit(&presenter->quit, memory_order_acquire);
+
+        if (!frame_queue_pop(presenter->present, &frame))
+        {
+            if (quit)
+            {
+                break;
+            }
+
+            poll_wait();
+            continue;
+        }
+
+        framebuffer_t* image = display_image(presenter, frame.framebuffer);
+
+        // tiles nothing was drawn to are filled on the way
+        if (frame.framebuffer == image)
+        {
+            framebuffer_resolve_clear(image);
+        }
+        else if (!presenter->upscale)
+        {
+            framebuffer_detile(frame.framebuffer, image);
+        }
+        else
+        {
+            framebuffer_upscale(presenter->upscale, frame.framebuffer, image);
+        }
+
+        display_draw(presenter->display, image);
+        display_wait(presenter->display, image);
+
+        uint64_t latency = (uint64_t)(time_now() - frame.submitted);
+
+        // only this thread writes, the renderer reads them for statistics
+        atomic_fetch_add_explicit(&presenter->frames, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&presenter->latency_total, latency, memory_order_relaxed);
+
+        if (latency > atomic_load_explicit(&presenter->latency_max, memory_order_relaxed))
+        {
+            atomic_store_explicit(&presenter->latency_max, latency, memory_order_relaxed);
+        }
+
+        bool success = frame_queue_push(presenter->free, frame);
+        assert(success);
+    }
+
+    return thrd_success;
+}
+
+/********************/
+/* public functions */
+/********************/
+
+presenter_t* presenter_new(display_t* display, uint32_t frames_in_flight, bool tiled, uint32_t width, uint32_t height)
+{
+    assert(frames_in_flight > 0 && frames_in_flight <= DISPLAY_BUFFERS && frames_in_flight < FRAME_QUEUE_SIZE);
+
+    presenter_t* presenter          = calloc(1, sizeof(presenter_t));
+
+    presenter->display              = display;
+    presenter->free                 = frame_queue_new();
+    presenter->present              = frame_queue_new();
+    presenter->frames_in_flight     = frames_in_flight;
+    presenter->owned                = false;
+    presenter->upscale              = NULL;
+
+    atomic_init(&presenter->quit, false);
+    atomic_init(&presenter->frames, 0);
+    atomic_init(&presenter->latency_total, 0);
+    atomic_init(&presenter->latency_max, 0);
+
+    for (uint32_t i = 0; i < frames_in_flight; i++)
+    {
+        framebuffer_t* image = display_framebuffer(display, i);
+
+        // the display's images start out undefined
+        framebuffer_clear(image);
+
+        if (tiled || width != image->width || height != image->height)
+        {
+            image = framebuffer_new(width, height);
+            framebuffer_set_layout(image, tiled ? FRAMEBUFFER_LAYOUT_TILED : FRAMEBUFFER_LAYOUT_LINEAR);
+            presenter->owned = true;
+        }
+
+        presenter->targets[i] = image;
+
+        frame_t frame = { .framebuffer = image, .submitted = 0 };
+        frame_queue_push(presenter->free, frame);
+    }
+
+    // every target and every image has the same size and layout
+    framebuffer_t* image = display_framebuffer(display, 0);
+
+    if (width != image->width || height != image->height)
+    {
+        presenter->upscale = framebuffer_upscale_table_new(presenter->targets[0], image);
+    }
+
+    int32_t success = thrd_create(&presenter->thread, present_frames, presenter);
+    assert(success == thrd_success);
+
+    return presenter;
+}
+
+framebuffer_t* presenter_acquire(presenter_t* presenter)
+{
+    timestamp_t start = time_now();
+    frame_t frame;
+
+    while (!frame_queue_pop(presenter->free, &frame))
+    {
+        poll_wait();
+    }
+
+    presenter->stall_total += (uint64_t)(time_now() - start);
+
+    return frame.framebuffer;
+}
+
+void presenter_submit(presenter_t* presenter, framebuffer_t* framebuffer)
+{
+    frame_t frame   = { .framebuffer = framebuffer, .submitted = time_now() };
+
+    // never full, at most frames_in_flight framebuffers circulate
+    bool success    = frame_queue_push(presenter->present, frame);
+    assert(success);
+}
+
+void presenter_flush(presenter_t* presenter)
+{
+    // every submitted frame is presented once all framebuffers are back
+    while (frame_queue_size(presenter->free) < presenter->frames_in_flight)
+    {
+        poll_wait();
+    }
+}
+
+presenter_stats_t presenter_stats(presenter_t* presenter)
+{
+    presenter_stats_t stats = {
+        .frames         = atomic_load_explicit(&presenter->frames, memory_order_relaxed),
+        .latency_total  = atomic_load_explicit(&presenter->latency_total, memory_order_relaxed),
+        .latency_max    = atomic_load_explicit(&presenter->latency_max, memory_order_relaxed),
+        .stall_total    = presenter->stall_total
+    };
+
+    return stats;
+}
+
+void presenter_free(presenter_t* presenter)
+{
+    atomic_store_explicit(&presenter->quit, true, memory_order_release);
+    thrd_join(presenter->thread, NULL);
+
+    for (uint32_t i = 0; i < presenter->frames_in_flight && presenter->owned; i++)
+    {
+        framebuffer_free(presenter->targets[i]);
+    }
+
+    if (presenter->upscale)
+    {
+        framebuffer_upscale_table_free(presenter->upscale);
+    }
+
+    frame_queue_free(presenter->free);
+    frame_queue_free(presenter->present);
+    free(presenter);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <threads.h>
+
+#include "atomic_types.h"
+#include "frame_queue.h"
+#include "framebuffer.h"
+#include "display.h"
+
+typedef struct
+{
+    uint64_t    frames;
+    uint64_t    latency_total;  // ns from submit until the server finished reading the frame
+    uint64_t    latency_max;
+    uint64_t    stall_total;    // ns the renderer waited for a free framebuffer
+
+} presenter_stats_t;
+
+typedef struct
+{
+    display_t*      display;
+    framebuffer_t*  targets[DISPLAY_BUFFERS];   // handed to the renderer, the display's images unless owned
+    bool            owned;      // targets are tiled or smaller than the images
+    framebuffer_upscale_table_t* upscale;   // targets smaller than the images, NULL otherwise
+    frame_queue_t*  free;       // framebuffers ready to render into, presenter to renderer
+    frame_queue_t*  present;    // finished frames, renderer to presenter
+    uint32_t        frames_in_flight;
+    thrd_t          thread;
+    atomic_bool_t   quit;
+    atomic_uint64_t frames;
+    atomic_uint64_t latency_total;
+    atomic_uint64_t latency_max;
+    uint64_t        stall_total;
+
+} presenter_t;
+
+presenter_t*        presenter_new(display_t* display, uint32_t frames_in_flight, bool tiled, uint32_t width, uint32_t height);
+framebuffer_t*      presenter_acquire(presenter_t* presenter);
+void                presenter_submit(presenter_t* presenter, framebuffer_t* framebuffer);
+void                presenter_flush(presenter_t* presenter);
+presenter_stats_t   presenter_stats(presenter_t* presenter);
+void                presenter_free(presenter_t* presenter);
\ No newline at end of file
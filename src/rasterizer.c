@@ -10,16 +10,23 @@
 /********************
  *  Notes
  *
+ * Screen space y goes down, rows are stored top first. Triangles facing the camera have positive edge functions
+ * inside. Shaded pixels are collected per row and written as spans, a run ends at the first pixel that is not
+ * covered or fails the depth test.
  ********************/
 
 /********************/
 /*      defines     */
 /********************/
 
+#define MAX_SPAN 64
+
 /********************/
 /* static variables */
 /********************/
 
+static vrs_map_t* shading_rates = NULL;
+
 /********************/
 /* static functions */
 /********************/
@@ -31,10 +38,45 @@ static int32_t edge_check(int32_t x0, int32_t y0,
     return (x2 - x0) * (y1 - y0) - (x1 - x0) * (y2 - y0);
 }
 
+// shades once per coarse pixel of the tile's rate and reuses the colour for the rest of the triangle
+static uint32_t shade_coarse(uint32_t stamp, uint32_t x, uint32_t y, float w0, float w1, float w2)
+{
+    shading_rate_e rate = vrs_map_get(shading_rates, x, y);
+
+    if (rate == SHADING_RATE_1X1)
+    {
+        return shader_fragment(x, y, w0, w1, w2);
+    }
+
+    uint32_t cell = vrs_map_cell(shading_rates, x, y, rate);
+
+    if (shading_rates->stamps[cell] != stamp)
+    {
+        shading_rates->stamps[cell] = stamp;
+        shading_rates->colors[cell] = shader_fragment(x, y, w0, w1, w2);
+    }
+
+    return shading_rates->colors[cell];
+}
+
+static void flush_span(framebuffer_t* framebuffer, uint32_t x, uint32_t y, const uint32_t* colors, uint32_t* size)
+{
+    if (*size > 0)
+    {
+        framebuffer_write_span(framebuffer, x, y, colors, *size);
+        *size = 0;
+    }
+}
+
 /********************/
 /* public functions */
 /********************/
 
+void rasterizer_set_shading_rates(vrs_map_t* rates)
+{
+    shading_rates = rates;
+}
+
 void rasterizer_draw_line(vec4_t v0,
                           vec4_t v1,
                           uint32_t color, 
@@ -133,8 +175,8 @@ void rasterizer_draw_triangle(vec4_t v0,
     // find min/max within buffer boundaries
     int32_t minx = (int32_t)fmax(fmin(fmin(x0, x1), x2), 0.f);
     int32_t miny = (int32_t)fmax(fmin(fmin(y0, y1), y2), 0.f);
-    int32_t maxx = (int32_t)fmin(fmax(fmax(x0, x1), x2), framebuffer->width - 1);
-    int32_t maxy = (int32_t)fmin(fmax(fmax(y0, y1), y2), framebuffer->height - 1);
+    int32_t maxx = (int32_t)fmin(fmax(fmax(x0, x1), x2), depthbuffer->width - 1);
+    int32_t maxy = (int32_t)fmin(fmax(fmax(y0, y1), y2), depthbuffer->height - 1);
 
     // area of parallelogram
     float area = (float)edge_check(x0, y0, x1, y1, x2, y2);
@@ -146,6 +188,24 @@ void rasterizer_draw_triangle(vec4_t v0,
 
 
     float inv_area  = 1.f / area;
+    uint32_t stamp  = 0;
+
+    if (framebuffer && shading_rates)
+    {
+        stamp       = vrs_map_next_stamp(shading_rates);
+    }
+
+    if (framebuffer)
+    {
+        // screen space gradients of the normalized edge functions, used for texture lod
+        vec4_t dw_dx = vec4_new((float)(y2 - y1) * inv_area, (float)(y0 - y2) * inv_area, (float)(y1 - y0) * inv_area);
+        vec4_t dw_dy = vec4_new((float)(x1 - x2) * inv_area, (float)(x2 - x0) * inv_area, (float)(x0 - x1) * inv_area);
+        shader_set_derivatives(dw_dx, dw_dy);
+    }
+
+    uint32_t span[MAX_SPAN];
+    uint32_t span_size  = 0;
+    uint32_t span_x     = 0;
 
     for (int32_t y = miny; y <= maxy; y++)
     {
@@ -155,8 +215,9 @@ void rasterizer_draw_triangle(vec4_t v0,
             float w1 = (float)edge_check(x2, y2, x0, y0, x, y);
             float w2 = (float)edge_check(x0, y0, x1, y1, x, y);
 
-            if (w0 > 0 || w1 > 0 || w2 > 0)
+            if (w0 < 0 || w1 < 0 || w2 < 0)
             {
+                flush_span(framebuffer, span_x, (uint32_t)y, span, &span_size);
                 continue;
             }
 
@@ -168,15 +229,43 @@ void rasterizer_draw_triangle(vec4_t v0,
             // perspective correct interpolation of z
             float depth = w0 * v0.z + w1 * v1.z + w2 * v2.z;
 
-            if (depth < depthbuffer_get(depthbuffer, (uint32_t)x, (uint32_t)y))
+            // reversed z, compared in the buffer's format
+            if (!depthbuffer_test(depthbuffer, (uint32_t)x, (uint32_t)y, depth))
             {
+                flush_span(framebuffer, span_x, (uint32_t)y, span, &span_size);
                 continue;
             }
 
-            uint32_t color = shader_fragment(w0, w1, w2);
+            // depth only pass (shadow maps), no shading
+            if (!framebuffer)
+            {
+                continue;
+            }
+
+            uint32_t color;
+
+            if (shading_rates)
+            {
+                color = shade_coarse(stamp, (uint32_t)x, (uint32_t)y, w0, w1, w2);
+            }
+            else
+            {
+                color = shader_fragment((uint32_t)x, (uint32_t)y, w0, w1, w2);
+            }
+
+            if (span_size == 0)
+            {
+                span_x = (uint32_t)x;
+            }
+
+            span[span_size++] = color;
 
-            depthbuffer_set(depthbuffer, (uint32_t)x, (uint32_t)y, depth);
-            framebuffer_set(framebuffer, (uint32_t)x, (uint32_t)y, color);
+            if (span_size == MAX_SPAN)
+            {
+                flush_span(framebuffer, span_x, (uint32_t)y, span, &span_size);
+            }
         }
+
+        flush_span(framebuffer, span_x, (uint32_t)y, span, &span_size);
     }
 }
\ No newline at end of file
@@ -4,12 +4,17 @@
 #include "mesh.h"
 #include "framebuffer.h"
 #include "depthbuffer.h"
+#include "vrs.h"
+
+// NULL shades every pixel
+void rasterizer_set_shading_rates(vrs_map_t* rates);
 
 void rasterizer_draw_line(vec4_t p0,
                           vec4_t p1,
                           uint32_t color,
                           framebuffer_t* framebuffer);
 
+// a NULL framebuffer only writes the depthbuffer
 void rasterizer_draw_triangle(vec4_t v0,
                               vec4_t v1,
                               vec4_t v2,
@@ -7,43 +7,140 @@
 #include <string.h>
 #include <stdbool.h>
 
-#include "linux/input.h"
+#include "input.h"
 #include "time_utils.h"
 #include "rasterizer.h"
-#include "constants.h"
 #include "shader.h"
 #include "settings.h"
+#include "ssao.h"
+#include "texture_stream.h"
+#include "presenter.h"
+#include "resolution_scaler.h"
 
 /********************
  *  Notes
  *
+ * Everything the frame is rendered into has the render resolution, the window size times the render scale. A
+ * resize waits for the presenter to show the frames in flight, then the images, render targets and screen space
+ * buffers are recreated. The camera keeps its horizontal field of view and takes the aspect ratio of the window.
+ *
+ * With dynamic resolution the render scale follows the time spent rendering, from after the framebuffer was
+ * acquired until the frame was submitted. Waiting on the presenter is left out, it does not shrink with the scale.
  ********************/
 
 /********************/
 /*      defines     */
 /********************/
 
+#define FRAME_TIME (16 * MILLISECOND)     // 60fps
+
 /********************/
 /* static variables */
 /********************/
 
 static scene_t* scene               = NULL;
 static display_t* display           = NULL;
-static framebuffer_t* front         = NULL;
-static framebuffer_t* back          = NULL;
+static presenter_t* presenter       = NULL;
 static framebuffer_t* current       = NULL;
 static depthbuffer_t* depthbuffer   = NULL;
+static light_grid_t* light_grid     = NULL;
+static ibl_t* environment           = NULL;
+static shadow_map_t* shadow_map     = NULL;
+static ssao_t* ssao                 = NULL;
+static vrs_map_t* vrs_map           = NULL;
 static bool wireframe               = false;
+static presenter_stats_t stats      = { 0 };
+static resolution_scaler_t* scaler  = NULL;
 
 /********************/
 /* static functions */
 /********************/
 
+static void renderer_create_targets()
+{
+    uint32_t width  = get_render_width();
+    uint32_t height = get_render_height();
+
+    presenter       = presenter_new(display, get_frames_in_flight(), get_framebuffer_tiling(), width, height);
+    depthbuffer     = depthbuffer_new(width, height);
+    light_grid      = light_grid_new(width, height);
+    ssao            = ssao_new(width, height);
+    vrs_map         = vrs_map_new(width, height);
+
+    depthbuffer_set_format(depthbuffer, get_depth_format());
+
+    if (get_framebuffer_tiling())
+    {
+        depthbuffer_set_layout(depthbuffer, FRAMEBUFFER_LAYOUT_TILED);
+    }
+
+    if (scene)
+    {
+        camera_set_aspect_ratio(scene->camera, (float)get_window_width() / (float)get_window_height());
+    }
+}
+
+static void renderer_free_targets()
+{
+    // presents the frames still queued
+    presenter_flush(presenter);
+
+    presenter_stats_t last  = presenter_stats(presenter);
+    stats.frames           += last.frames;
+    stats.latency_total    += last.latency_total;
+    stats.latency_max       = last.latency_max > stats.latency_max ? last.latency_max : stats.latency_max;
+    stats.stall_total      += last.stall_total;
+
+    presenter_free(presenter);
+    depthbuffer_free(depthbuffer);
+    light_grid_free(light_grid);
+    ssao_free(ssao);
+    vrs_map_free(vrs_map);
+}
+
+static void renderer_resize()
+{
+    renderer_free_targets();
+    display_resize(display, get_window_width(), get_window_height());
+    renderer_create_targets();
+}
+
+static void renderer_scale(timestamp_t render_time)
+{
+    float scale = resolution_scaler_update(scaler, get_render_scale(), render_time);
+
+    if (scale != get_render_scale())
+    {
+        set_render_scale(scale);
+        renderer_resize();
+        printf("render scale %.4f, %ux%u\n", (double)get_render_scale(), get_render_width(), get_render_height());
+    }
+}
+
 static void renderer_update(input_t input)
 {
+    // ConfigureNotify also reports moves, sizes below the minimum are clamped
+    if (input.width > 0)
+    {
+        uint32_t width  = get_window_width();
+        uint32_t height = get_window_height();
+
+        set_window_size(input.width, input.height);
+
+        if (get_window_width() != width || get_window_height() != height)
+        {
+            renderer_resize();
+        }
+    }
+
     scene_update(scene, input);
 
+    // levels sampled last frame, nothing samples until the next draw
+    texture_stream_update();
+
     if (input.keys & KEY_2) { change_texture_filter(); }
+    if (input.keys & KEY_3) { change_ssao(); }
+    if (input.keys & KEY_4) { change_vrs(); }
 }
 
 // static void renderer_draw_utilities()
@@ -70,7 +167,7 @@ static void renderer_update(input_t input)
 //         points[i]   = mat_mul_vec(PV, points[i]);
 //         points[i]   = vec4_scale(points[i], 1.f/points[i].w);
 //         points[i].x = (points[i].x + 1.f) * 0.5f * w;
-//         points[i].y = (points[i].y + 1.f) * 0.5f * h;
+//         points[i].y = (1.f - points[i].y) * 0.5f * h;
 //     }
 
 //     rasterizer_draw_line(points[0], points[1], colors[1], current);
@@ -78,7 +175,7 @@ static void renderer_update(input_t input)
 //     rasterizer_draw_line(points[0], points[3], colors[3], current);
 // }
 
-static void renderer_draw_mesh(mesh_t* mesh)
+static void renderer_draw_mesh(mesh_t* mesh, framebuffer_t* target)
 {
 
     uint32_t i0;
@@ -97,8 +194,8 @@ static void renderer_draw_mesh(mesh_t* mesh)
     vec4_t n1;
     vec4_t n2;
 
-    float w_over_2          = (float)WINDOW_WIDTH * 0.5f;
-    float h_over_2          = (float)WINDOW_HEIGHT * 0.5f;
+    float w_over_2          = (float)depthbuffer->width * 0.5f;
+    float h_over_2          = (float)depthbuffer->height * 0.5f;
 
     camera_t* cam           = scene->camera;
 
@@ -137,6 +234,7 @@ static void renderer_draw_mesh(mesh_t* mesh)
                             mesh->albedo,
                             mesh->metallic,
                             mesh->normal,
+                            mesh->occlusion,
                             v0, v1, v2,
                             t0, t1, t2,
                             n0, n1, n2);
@@ -151,15 +249,15 @@ static void renderer_draw_mesh(mesh_t* mesh)
         v1 = vec4_scale(v1, 1.f / v1.w);
         v2 = vec4_scale(v2, 1.f / v2.w);
 
-        // viewport transform
+        // viewport transform, y flipped so row 0 is the top of the screen
         v0.x = (v0.x + 1.f) * w_over_2;
-        v0.y = (v0.y + 1.f) * h_over_2;
+        v0.y = (1.f - v0.y) * h_over_2;
         v1.x = (v1.x + 1.f) * w_over_2;
-        v1.y = (v1.y + 1.f) * h_over_2;
+        v1.y = (1.f - v1.y) * h_over_2;
         v2.x = (v2.x + 1.f) * w_over_2;
-        v2.y = (v2.y + 1.f) * h_over_2;
+        v2.y = (1.f - v2.y) * h_over_2;
 
-        rasterizer_draw_triangle(v0, v1, v2, current, depthbuffer);
+        rasterizer_draw_triangle(v0, v1, v2, target, depthbuffer);
     }
 }
 
@@ -167,13 +265,43 @@ static void renderer_draw()
 {
     // renderer_draw_utilities();
 
-    renderer_draw_mesh(scene->mesh);
+    // shadow maps are rendered on worker threads while the light grid is built
+    shadow_map_render_begin(shadow_map, scene->lights, scene->lights_size, scene->camera, scene->mesh);
 
-    display_draw(display, current);
+    light_grid_build(light_grid, scene->lights, scene->lights_size, scene->camera);
+    shader_set_lights(scene->lights, light_grid);
+
+    shadow_map_render_end(shadow_map);
+    shader_set_shadows(shadow_map);
+
+    if (get_ssao())
+    {
+        // depth prepass, the occlusion has to be known before the ambient term is shaded
+        renderer_draw_mesh(scene->mesh, NULL);
+
+        // occlusion radius follows the size of the scene
+        ssao_compute(ssao, depthbuffer, scene->camera, scene->mesh->bounding_sphere.r * 0.1f);
+    }
+
+    shader_set_ssao(get_ssao() ? ssao : NULL);
+    rasterizer_set_shading_rates(get_vrs() ? vrs_map : NULL);
+
+    renderer_draw_mesh(scene->mesh, current);
+
+    // rates for the next frame come from this one
+    if (get_vrs())
+    {
+        vrs_map_update(vrs_map, current);
+    }
+
+    // shown on the presenter thread while the next frame renders
+    presenter_submit(presenter, current);
 }
 
 static void renderer_clear_buffers()
 {
+    // frames are rendered into the display's images, the presenter hands them back once the server read them
+    current = presenter_acquire(presenter);
     framebuffer_clear(current);
     depthbuffer_clear(depthbuffer);
     display_clear(display);
@@ -185,13 +313,15 @@ static void renderer_clear_buffers()
 
 void renderer_init()
 {
-    display       = display_new();
-
-    front         = framebuffer_new(WINDOW_WIDTH, WINDOW_HEIGHT);
-    back          = framebuffer_new(WINDOW_WIDTH, WINDOW_HEIGHT);
-    current       = front;
-    depthbuffer   = depthbuffer_new(WINDOW_WIDTH, WINDOW_HEIGHT);
+    display       = display_new(get_headless() ? DISPLAY_BACKEND_HEADLESS : DISPLAY_BACKEND_X11,
+                                get_window_width(),
+                                get_window_height());
+    current       = NULL;
+    shadow_map    = shadow_map_new(SHADOW_MAP_SIZE);
+    scaler        = resolution_scaler_new(FRAME_TIME, get_min_dynamic_scale(), get_max_dynamic_scale());
     wireframe     = false;
+
+    renderer_create_targets();
 }
 
 void renderer_load(const char* file_path)
@@ -202,6 +332,18 @@ void renderer_load(const char* file_path)
     }
     
     scene = scene_new(file_path);
+    camera_set_aspect_ratio(scene->camera, (float)get_window_width() / (float)get_window_height());
+}
+
+void renderer_load_environment(const char* file_path)
+{
+    if (environment)
+    {
+        ibl_free(environment);
+    }
+
+    environment = ibl_new(file_path);
+    shader_set_environment(environment);
 }
 
 void renderer_run()
@@ -210,30 +352,37 @@ void renderer_run()
     timestamp_t start;
     timestamp_t end;
     timestamp_t diff;
-    timestamp_t frame_time = 16 * MILLISECOND;
+    timestamp_t render_start;
+    timestamp_t run_start = time_now();
+    uint32_t frames = 0;
     struct timespec sleep_timer = { 0, 0 };
 
     while (!quit)
     {
         start = time_now();
 
-        input_t input = handle_input(display);
+        input_t input = display_input(display);
 
         renderer_update(input);
 
-        renderer_draw();
-
         renderer_clear_buffers();
 
-        current = current == front ? back : front;
+        render_start = time_now();
+
+        renderer_draw();
 
-        // maintain 60fps
+        if (get_dynamic_resolution())
+        {
+            renderer_scale(time_now() - render_start);
+        }
+
+        // maintain 60fps, headless runs measure throughput and never wait
         end = time_now();
         diff = end - start;
 
-        if (frame_time > diff)
+        if (FRAME_TIME > diff && !get_headless())
         {
-            sleep_timer.tv_nsec = frame_time - diff;
+            sleep_timer.tv_nsec = FRAME_TIME - diff;
             nanosleep(&sleep_timer, NULL);
         }
 
@@ -241,7 +390,14 @@ void renderer_run()
 
         // quit
         quit = input.keys & QUIT;
+        frames++;
     }
+
+    // the last frames count once they were presented
+    presenter_flush(presenter);
+    timestamp_t run_time = time_now() - run_start;
+
+    printf("%u frames in %ldms, %.1f fps\n", frames, run_time / MILLISECOND, (double)frames * SECOND / (double)run_time);
 }
 
 void renderer_free()
@@ -250,8 +406,22 @@ void renderer_free()
     {
         scene_free(scene);
     }
+    if (environment)
+    {
+        ibl_free(environment);
+    }
+
+    renderer_free_targets();
     display_free(display);
-    framebuffer_free(front);
-    framebuffer_free(back);
-    depthbuffer_free(depthbuffer);
+
+    if (stats.frames > 0)
+    {
+        printf("present latency %luus average, %luus max, renderer stalled %luus\n",
+               stats.latency_total / stats.frames / MICROSECOND,
+               stats.latency_max / MICROSECOND,
+               stats.stall_total / MICROSECOND);
+    }
+
+    shadow_map_free(shadow_map);
+    resolution_scaler_free(scaler);
 }
\ No newline at end of file
@@ -5,9 +5,10 @@
 #include "scene.h"
 #include "framebuffer.h"
 #include "depthbuffer.h"
-#include "linux/display.h"
+#include "display.h"
 
 void renderer_init();
 void renderer_load(const char* file_path);
+void renderer_load_environment(const char* file_path);
 void renderer_run();
 void renderer_free();
@@ -0,0 +1,103 @@
+#include "resolution_scaler.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+/********************
+ *  Notes
+ *
+ * Picks the render scale for the next frames from the render time of the last ones. Render time is taken as
+ * proportional to the pixel count, the square of the scale, so the scale that fits the budget is the current one
+ * times the square root of budget over measured time. Parts of the frame that do not depend on the resolution
+ * make that estimate optimistic when going down and pessimistic when going up, the next decisions correct it.
+ *
+ * Every change recreates the render targets and drains the frames in flight, so the scale moves in steps and
+ * only after a full history was measured at the current one. Over budget it drops straight to the estimate,
+ * with room left in the budget it rises a single step, which keeps it from oscillating around the target.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define RESOLUTION_HEADROOM 0.9f        // fraction of the budget aimed for when dropping
+#define RESOLUTION_RAISE    0.75f       // fraction of the budget below which the scale rises
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static float clamp_scale(const resolution_scaler_t* scaler, float scale)
+{
+    return scale < scaler->min_scale ? scaler->min_scale : (scale > scaler->max_scale ? scaler->max_scale : scale);
+}
+
+/********************/
+/* public functions */
+/********************/
+
+resolution_scaler_t* resolution_scaler_new(timestamp_t target, float min_scale, float max_scale)
+{
+    assert(target > 0 && min_scale > 0.f && min_scale <= max_scale);
+
+    resolution_scaler_t* scaler = calloc(1, sizeof(resolution_scaler_t));
+
+    scaler->target              = target;
+    scaler->min_scale           = min_scale;
+    scaler->max_scale           = max_scale;
+
+    return scaler;
+}
+
+float resolution_scaler_update(resolution_scaler_t* scaler, float scale, timestamp_t render_time)
+{
+    float result                    = clamp_scale(scaler, scale);
+
+    scaler->history[scaler->next]   = render_time;
+    scaler->next                    = (scaler->next + 1) % RESOLUTION_HISTORY;
+    scaler->count                   = scaler->count < RESOLUTION_HISTORY ? scaler->count + 1 : RESOLUTION_HISTORY;
+
+    if (result == scale && scaler->count == RESOLUTION_HISTORY)
+    {
+        timestamp_t total = 0;
+
+        for (uint32_t i = 0; i < RESOLUTION_HISTORY; i++)
+        {
+            total += scaler->history[i];
+        }
+
+        float average   = (float)total / RESOLUTION_HISTORY;
+        float budget    = (float)scaler->target;
+        float estimate  = scale * sqrtf(budget * RESOLUTION_HEADROOM / average);
+
+        if (average > budget)
+        {
+            // at least one step down
+            float stepped   = floorf(estimate / RESOLUTION_STEP) * RESOLUTION_STEP;
+            result          = clamp_scale(scaler, fminf(stepped, scale - RESOLUTION_STEP));
+        }
+        else if (average < budget * RESOLUTION_RAISE && estimate >= scale + RESOLUTION_STEP)
+        {
+            result          = clamp_scale(scaler, scale + RESOLUTION_STEP);
+        }
+    }
+
+    // times measured at another scale say nothing about the new one
+    if (result != scale)
+    {
+        scaler->count   = 0;
+        scaler->next    = 0;
+    }
+
+    return result;
+}
+
+void resolution_scaler_free(resolution_scaler_t* scaler)
+{
+    free(scaler);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "time_utils.h"
+
+#define RESOLUTION_HISTORY  8           // frames averaged before the scale changes
+#define RESOLUTION_STEP     0.0625f     // scales move in 1/16 steps of the window size
+
+typedef struct
+{
+    timestamp_t target;                 // render time budget of a frame
+    float       min_scale;
+    float       max_scale;
+    timestamp_t history[RESOLUTION_HISTORY];
+    uint32_t    count;                  // frames measured at the current scale, up to RESOLUTION_HISTORY
+    uint32_t    next;                   // history slot written next
+
+} resolution_scaler_t;
+
+resolution_scaler_t*    resolution_scaler_new(timestamp_t target, float min_scale, float max_scale);
+float                   resolution_scaler_update(resolution_scaler_t* scaler, float scale, timestamp_t render_time);
+void                    resolution_scaler_free(resolution_scaler_t* scaler);
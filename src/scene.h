@@ -1,14 +1,15 @@
 #pragma once
 
 #include "mesh.h"
+#include "light.h"
 #include "camera.h"
 
 typedef struct
 {
     mesh_t*     mesh;
     camera_t*   camera;
-    // vec4_t    dir_light;
-    // vec4_t    point_light;
+    light_t     lights[MAX_LIGHTS];
+    uint32_t    lights_size;
 } scene_t;
 
 scene_t*    scene_new(const char* file_path);
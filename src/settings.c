@@ -1,10 +1,16 @@
 #include "settings.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "constants.h"
+
 /********************
  *  Notes
  *
+ * The render resolution is the window size times the render scale, frames rendered smaller are upscaled to the
+ * window when presented, see framebuffer_upscale. With dynamic resolution the renderer moves the scale between
+ * the dynamic bounds to keep frames within budget, see resolution_scaler.c.
  ********************/
 
 /********************/
@@ -15,7 +21,28 @@
 /* static variables */
 /********************/
 
-static texture_filter_e texture_filter = BILINEAR_SAMPLE;
+static texture_filter_e texture_filter = TRILINEAR_SAMPLE;
+static uint32_t max_anisotropy         = 8;
+static bool texture_compression        = false;
+static bool texture_tiling             = false;     // measured slower than linear for minified textures
+static bool texture_streaming          = false;
+static uint32_t texture_budget         = DEFAULT_TEXTURE_BUDGET;
+static bool texture_atlas              = false;
+static bool ssao                       = false;
+static bool vrs                        = false;
+static bool framebuffer_tiling         = false;
+static depth_format_e depth_format     = DEPTH_FORMAT_F32;
+static uint32_t frames_in_flight       = MIN_FRAMES_IN_FLIGHT;
+static uint32_t window_width           = WINDOW_WIDTH;
+static uint32_t window_height          = WINDOW_HEIGHT;
+static float render_scale              = MAX_RENDER_SCALE;
+static bool dynamic_resolution         = false;
+static float min_dynamic_scale         = DEFAULT_MIN_DYNAMIC_SCALE;
+static float max_dynamic_scale         = MAX_RENDER_SCALE;
+static bool headless                   = false;
+static uint32_t headless_frames        = DEFAULT_HEADLESS_FRAMES;
+static const char* input_script        = NULL;
+static const char* frame_dump          = NULL;
 
 /********************/
 /* static functions */
@@ -43,4 +70,225 @@ void change_texture_filter()
     }
     
     texture_filter = (texture_filter_e)filter;
+}
+
+uint32_t get_max_anisotropy()
+{
+    return max_anisotropy;
+}
+
+void set_max_anisotropy(uint32_t probes)
+{
+    max_anisotropy = probes < MIN_ANISOTROPY ? MIN_ANISOTROPY : (probes > MAX_ANISOTROPY ? MAX_ANISOTROPY : probes);
+}
+
+bool get_texture_compression()
+{
+    return texture_compression;
+}
+
+void change_texture_compression()
+{
+    texture_compression = !texture_compression;
+}
+
+bool get_texture_tiling()
+{
+    return texture_tiling;
+}
+
+void change_texture_tiling()
+{
+    texture_tiling = !texture_tiling;
+}
+
+bool get_texture_streaming()
+{
+    return texture_streaming;
+}
+
+void change_texture_streaming()
+{
+    texture_streaming = !texture_streaming;
+}
+
+uint32_t get_texture_budget()
+{
+    return texture_budget;
+}
+
+void set_texture_budget(uint32_t bytes)
+{
+    texture_budget = bytes;
+}
+
+bool get_texture_atlas()
+{
+    return texture_atlas;
+}
+
+void change_texture_atlas()
+{
+    texture_atlas = !texture_atlas;
+}
+
+bool get_ssao()
+{
+    return ssao;
+}
+
+void change_ssao()
+{
+    ssao = !ssao;
+}
+
+bool get_vrs()
+{
+    return vrs;
+}
+
+void change_vrs()
+{
+    vrs = !vrs;
+}
+
+bool get_framebuffer_tiling()
+{
+    return framebuffer_tiling;
+}
+
+void change_framebuffer_tiling()
+{
+    framebuffer_tiling = !framebuffer_tiling;
+}
+
+depth_format_e get_depth_format()
+{
+    return depth_format;
+}
+
+void set_depth_format(depth_format_e format)
+{
+    depth_format = format < DEPTH_FORMAT_SIZE ? format : DEPTH_FORMAT_F32;
+}
+
+uint32_t get_frames_in_flight()
+{
+    return frames_in_flight;
+}
+
+void set_frames_in_flight(uint32_t frames)
+{
+    frames_in_flight = frames < MIN_FRAMES_IN_FLIGHT ? MIN_FRAMES_IN_FLIGHT : (frames > MAX_FRAMES_IN_FLIGHT ? MAX_FRAMES_IN_FLIGHT : frames);
+}
+
+uint32_t get_window_width()
+{
+    return window_width;
+}
+
+uint32_t get_window_height()
+{
+    return window_height;
+}
+
+void set_window_size(uint32_t width, uint32_t height)
+{
+    window_width    = width < MIN_WINDOW_SIZE ? MIN_WINDOW_SIZE : width;
+    window_height   = height < MIN_WINDOW_SIZE ? MIN_WINDOW_SIZE : height;
+}
+
+float get_render_scale()
+{
+    return render_scale;
+}
+
+void set_render_scale(float scale)
+{
+    render_scale = scale < MIN_RENDER_SCALE ? MIN_RENDER_SCALE : (scale > MAX_RENDER_SCALE ? MAX_RENDER_SCALE : scale);
+}
+
+uint32_t get_render_width()
+{
+    uint32_t width = (uint32_t)((float)window_width * render_scale + 0.5f);
+
+    return width > 0 ? width : 1;
+}
+
+uint32_t get_render_height()
+{
+    uint32_t height = (uint32_t)((float)window_height * render_scale + 0.5f);
+
+    return height > 0 ? height : 1;
+}
+
+bool get_dynamic_resolution()
+{
+    return dynamic_resolution;
+}
+
+void change_dynamic_resolution()
+{
+    dynamic_resolution = !dynamic_resolution;
+}
+
+float get_min_dynamic_scale()
+{
+    return min_dynamic_scale;
+}
+
+float get_max_dynamic_scale()
+{
+    return max_dynamic_scale;
+}
+
+void set_dynamic_scale_bounds(float min_scale, float max_scale)
+{
+    min_dynamic_scale = min_scale < MIN_RENDER_SCALE ? MIN_RENDER_SCALE : (min_scale > MAX_RENDER_SCALE ? MAX_RENDER_SCALE : min_scale);
+    max_dynamic_scale = max_scale < min_dynamic_scale ? min_dynamic_scale : (max_scale > MAX_RENDER_SCALE ? MAX_RENDER_SCALE : max_scale);
+}
+
+bool get_headless()
+{
+#if defined(HEADLESS)
+    // built without X11, see the Makefile
+    return true;
+#else
+    return headless;
+#endif
+}
+
+void change_headless()
+{
+    headless = !headless;
+}
+
+uint32_t get_headless_frames()
+{
+    return headless_frames;
+}
+
+void set_headless_frames(uint32_t frames)
+{
+    headless_frames = frames;
+}
+
+const char* get_input_script()
+{
+    return input_script;
+}
+
+void set_input_script(const char* file_path)
+{
+    input_script = file_path;
+}
+
+const char* get_frame_dump()
+{
+    return frame_dump;
+}
+
+void set_frame_dump(const char* directory)
+{
+    frame_dump = directory;
 }
\ No newline at end of file
@@ -1,11 +1,71 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "depthbuffer.h"
+
+#define MIN_ANISOTROPY 2
+#define MAX_ANISOTROPY 16
+#define DEFAULT_TEXTURE_BUDGET (64u << 20) /* bytes of streamed texture levels */
+#define MIN_FRAMES_IN_FLIGHT 2
+#define MAX_FRAMES_IN_FLIGHT 3
+#define MIN_WINDOW_SIZE 16
+#define MIN_RENDER_SCALE 0.25f /* of the window size on both axes */
+#define MAX_RENDER_SCALE 1.f
+#define DEFAULT_MIN_DYNAMIC_SCALE 0.5f
+#define DEFAULT_HEADLESS_FRAMES 100
+
 typedef enum
 {
     POINT_SAMPLE = 0,
     BILINEAR_SAMPLE,
+    TRILINEAR_SAMPLE,
+    ANISOTROPIC_SAMPLE,
     TEXTURE_FILTER_SIZE
 } texture_filter_e;
 
 texture_filter_e    get_texture_filter();
-void                change_texture_filter();
\ No newline at end of file
+void                change_texture_filter();
+uint32_t            get_max_anisotropy();
+void                set_max_anisotropy(uint32_t probes);
+bool                get_texture_compression();
+void                change_texture_compression();
+bool                get_texture_tiling();
+void                change_texture_tiling();
+bool                get_texture_streaming();
+void                change_texture_streaming();
+bool                get_texture_atlas();
+void                change_texture_atlas();
+uint32_t            get_texture_budget();
+void                set_texture_budget(uint32_t bytes);
+bool                get_ssao();
+void                change_ssao();
+bool                get_vrs();
+void                change_vrs();
+bool                get_framebuffer_tiling();
+void                change_framebuffer_tiling();
+depth_format_e      get_depth_format();
+void                set_depth_format(depth_format_e format);
+uint32_t            get_frames_in_flight();
+void                set_frames_in_flight(uint32_t frames);
+uint32_t            get_window_width();
+uint32_t            get_window_height();
+void                set_window_size(uint32_t width, uint32_t height);
+float               get_render_scale();
+void                set_render_scale(float scale);
+uint32_t            get_render_width();
+uint32_t            get_render_height();
+bool                get_dynamic_resolution();
+void                change_dynamic_resolution();
+float               get_min_dynamic_scale();
+float               get_max_dynamic_scale();
+void                set_dynamic_scale_bounds(float min_scale, float max_scale);
+bool                get_headless();
+void                change_headless();
+uint32_t            get_headless_frames();
+void                set_headless_frames(uint32_t frames);
+const char*         get_input_script();
+void                set_input_script(const char* file_path);
+const char*         get_frame_dump();
+void                set_frame_dump(const char* directory);
\ No newline at end of file
@@ -30,6 +30,12 @@ static camera_t* camera             = NULL;
 static texture_t* albedo_texture    = NULL;
 static texture_t* metallic_texture  = NULL;
 static texture_t* normal_texture    = NULL;
+static texture_t* occlusion_texture = NULL;
+static const light_t* lights        = NULL;
+static const light_grid_t* grid     = NULL;
+static const ibl_t* environment     = NULL;
+static const shadow_map_t* shadows  = NULL;
+static const ssao_t* ssao           = NULL;
 static vec4_t v0_w;
 static vec4_t v1_w;
 static vec4_t v2_w;
@@ -40,6 +46,8 @@ static vec4_t n0;
 static vec4_t n1;
 static vec4_t n2;
 static vec4_t cam_w;
+static vec2_t duv_dx;
+static vec2_t duv_dy;
 
 /********************/
 /* static functions */
@@ -54,21 +62,6 @@ static vec4_t vec4_mix(vec4_t v0, vec4_t v1, float mix)
     return vec4_new(x, y, z);
 }
 
-// static vec4_t sample_normal(texture_t* tex, float u, float v)
-// {
-//     // fixme: this second sample method is needed because of the whole BGRA thing.
-//     //        Once a clear boundry is introduced and RGBA has been standardized in the renderer then this can be removed
-//     uint32_t u_idx = (uint32_t)(u * (float)tex->width) - 1;
-//     uint32_t v_idx = (uint32_t)(v * (float)tex->height) - 1;
-
-//     vec4_t temp = vec4_from_bgra(texture_get(tex, u_idx, v_idx));
-
-//     return vec4_new(temp.z * 2.f - 1.f,
-//                     temp.y * 2.f - 1.f,
-//                     temp.x * 2.f - 1.f);
-// }
-
-
 static float schlick_ggx(float dot, float k)
 {
     return dot / (dot * (1 - k) + k);
@@ -121,14 +114,142 @@ static vec4_t fresnel(float h_dot_v, vec4_t a, float m)
 }
 
 
+// Radiance scale of the light at pos_w, writes the direction towards the light
+static float light_attenuation(const light_t* light, vec4_t pos_w, vec4_t* light_w)
+{
+    if (light->type == DIRECTIONAL_LIGHT)
+    {
+        *light_w        = vec4_negate(light->direction_w);
+        return 1.f;
+    }
+
+    vec4_t to_light     = vec4_sub(light->position_w, pos_w);
+    float dist_sq       = f_max(vec4_magnitude_sq(to_light), 0.0001f);
+    float attenuation   = 1.f / dist_sq;
+    *light_w            = vec4_scale(to_light, 1.f / sqrtf(dist_sq));
+
+    // smooth window towards the range, as recommended by KHR_lights_punctual
+    if (light->range > 0.f)
+    {
+        float ratio     = dist_sq / (light->range * light->range);
+        float window    = f_clamp(1.f - ratio * ratio, 0.f, 1.f);
+        attenuation    *= window * window;
+    }
+
+    if (light->type == SPOT_LIGHT)
+    {
+        float cd        = -vec4_dot(light->direction_w, *light_w);
+        float cone      = (cd - light->outer_cos) / f_max(light->inner_cos - light->outer_cos, 0.0001f);
+        cone            = f_clamp(cone, 0.f, 1.f);
+        attenuation    *= cone * cone;
+    }
+
+    return attenuation;
+}
+
+
+// Outgoing radiance for a single light of unit intensity
+static vec4_t brdf(vec4_t n_w, vec4_t view_w, vec4_t light_w, vec4_t albedo, float rough, float metal)
+{
+    vec4_t one          = vec4_from_scalar(1.f);
+    vec4_t halfway_w    = vec4_normalize(vec4_add(view_w, light_w));
+
+    float n_dot_h       = f_max(vec4_dot(n_w, halfway_w),       0.f);
+    float n_dot_v       = f_max(vec4_dot(n_w, view_w),          0.f);
+    float n_dot_l       = f_max(vec4_dot(n_w, light_w),         0.f);
+    float h_dot_v       = f_max(vec4_dot(halfway_w, view_w),    0.f);
+
+    // specular
+    //      F * D * G
+    // ---------------------
+    // 4 * n_dot_l * n_dot_v
+
+    float d             = normal_dist(n_dot_h, rough);
+    float g             = self_shadow(n_dot_v, n_dot_l, rough);
+    vec4_t f            = fresnel(h_dot_v, albedo, metal);
+    float dg            = ( d * g ) / ( 4 * n_dot_l * n_dot_v + 0.001f );
+    vec4_t specular     = vec4_scale(f, dg);
+
+    // diffuse
+    //   kd * c
+    //  --------
+    //     pi
+
+    vec4_t kd           = vec4_sub(one, f);
+    kd                  = vec4_scale(kd, 1.f - metal);
+    kd                  = vec4_scale(kd, 1.f/F_PI);
+    vec4_t diffuse      = vec4_hadamard(albedo, kd);
+
+    vec4_t col          = vec4_add(diffuse, specular);
+    col                 = vec4_scale(col, n_dot_l);
+
+    return col;
+}
+
+
+// Split sum ambient: SH irradiance for diffuse, prefiltered radiance * (F0 * scale + bias) for specular
+static vec4_t ambient_ibl(vec4_t n_w, vec4_t view_w, vec4_t albedo, float rough, float metal)
+{
+    vec4_t one          = vec4_from_scalar(1.f);
+    float n_dot_v       = f_max(vec4_dot(n_w, view_w), 0.f);
+    vec4_t r_w          = vec4_sub(vec4_scale(n_w, 2.f * vec4_dot(n_w, view_w)), view_w);
+
+    vec4_t f0           = vec4_mix(vec4_from_scalar(0.04f), albedo, metal);
+    float exp           = f_pow(1.f - n_dot_v, 5.f);
+    vec4_t f_max_r      = vec4_new(f_max(1.f - rough, f0.x), f_max(1.f - rough, f0.y), f_max(1.f - rough, f0.z));
+    vec4_t f            = vec4_add(f0, vec4_scale(vec4_sub(f_max_r, f0), exp));
+
+    vec4_t kd           = vec4_scale(vec4_sub(one, f), 1.f - metal);
+    vec4_t irradiance   = ibl_irradiance(environment, n_w);
+    vec4_t diffuse      = vec4_hadamard(vec4_hadamard(kd, albedo), irradiance);
+
+    vec2_t brdf_lut     = ibl_brdf(environment, n_dot_v, rough);
+    vec4_t prefiltered  = ibl_specular(environment, r_w, rough);
+    vec4_t specular     = vec4_add(vec4_scale(f0, brdf_lut.x), vec4_from_scalar(brdf_lut.y));
+    specular            = vec4_hadamard(prefiltered, specular);
+
+    return vec4_add(diffuse, specular);
+}
+
+
 /********************/
 /* public functions */
 /********************/
 
+void shader_set_lights(const light_t* scene_lights, const light_grid_t* light_grid)
+{
+    lights              = scene_lights;
+    grid                = light_grid;
+}
+
+void shader_set_environment(const ibl_t* ibl)
+{
+    environment         = ibl;
+}
+
+void shader_set_shadows(const shadow_map_t* shadow_map)
+{
+    shadows             = shadow_map;
+}
+
+void shader_set_ssao(const ssao_t* ambient_occlusion)
+{
+    ssao                = ambient_occlusion;
+}
+
+void shader_set_derivatives(vec4_t dw_dx, vec4_t dw_dy)
+{
+    // barycentrics are affine in screen space, so the uv difference across a 2x2 quad is constant per triangle
+    duv_dx              = vec2_add(vec2_add(vec2_scale(t0, dw_dx.x), vec2_scale(t1, dw_dx.y)), vec2_scale(t2, dw_dx.z));
+    duv_dy              = vec2_add(vec2_add(vec2_scale(t0, dw_dy.x), vec2_scale(t1, dw_dy.y)), vec2_scale(t2, dw_dy.z));
+}
+
+
 void shader_set_uniforms(camera_t* cam,
                          texture_t* albedo_tex,
                          texture_t* metallic_tex,
                          texture_t* normal_tex,
+                         texture_t* occlusion_tex,
                          vec4_t v0, 
                          vec4_t v1, 
                          vec4_t v2,
@@ -145,6 +266,7 @@ void shader_set_uniforms(camera_t* cam,
     albedo_texture      = albedo_tex;
     metallic_texture    = metallic_tex;
     normal_texture      = normal_tex;
+    occlusion_texture   = occlusion_tex;
 
     mat_t M             = mat_new_identity();
     v0_w                = mat_mul_vec(M, v0);
@@ -173,20 +295,18 @@ vec4_t shader_vertex(vec4_t v)
 }
 
 
-uint32_t shader_fragment(float w0, float w1, float w2)
+uint32_t shader_fragment(uint32_t x, uint32_t y, float w0, float w1, float w2)
 {
-    vec4_t one          = vec4_from_scalar(1.f);
-
-    float s             = f_min(t0.x * w0 + t1.x * w1 + t2.x * w2, 1.f);
-    float t             = f_min(t0.y * w0 + t1.y * w1 + t2.y * w2, 1.f);
+    float s             = t0.x * w0 + t1.x * w1 + t2.x * w2;
+    float t             = t0.y * w0 + t1.y * w1 + t2.y * w2;
 
-    vec4_t albedo       = vec4_pow(texture_sample(albedo_texture, s, t), gamma_val);
-    vec4_t metallic     = texture_sample(metallic_texture, s, t);
+    vec4_t albedo       = texture_sample(albedo_texture, s, t, duv_dx, duv_dy);   // linear at load
+    vec4_t metallic     = texture_sample(metallic_texture, s, t, duv_dx, duv_dy);
     float rough         = metallic.y;                                       // green channel
     float metal         = metallic.x;                                       // blue channel
-    // vec_t o             = vec_from_bgra(sample(tri->occlusion, s, t));
+    float occlusion     = texture_sample(occlusion_texture, s, t, duv_dx, duv_dy).z;  // red channel
 
-    // vec4_t n_t          = vec4_normalize(sample_normal(normal_texture, s, t));
+    // vec4_t n_t          = vec4_normalize(texture_sample(normal_texture, s, t, duv_dx, duv_dy));
     vec4_t n_w          = vec4_scale(n0, w0);
     n_w                 = vec4_add(n_w, vec4_scale(n1, w1));
     n_w                 = vec4_add(n_w, vec4_scale(n2, w2));
@@ -215,42 +335,48 @@ uint32_t shader_fragment(float w0, float w1, float w2)
     pos_w               = vec4_add(pos_w, vec4_scale(v2_w, w2));
 
     vec4_t view_w       = vec4_normalize(vec4_sub(cam_w, pos_w));
-    vec4_t light_w      = vec4_normalize(one);
-    vec4_t halfway_w    = vec4_normalize(vec4_add(view_w, light_w));
-
-    float n_dot_h       = f_max(vec4_dot(n_w, halfway_w),       0.f);
-    float n_dot_v       = f_max(vec4_dot(n_w, view_w),          0.f);
-    float n_dot_l       = f_max(vec4_dot(n_w, light_w),         0.f);
-    float h_dot_v       = f_max(vec4_dot(halfway_w, view_w),    0.f);
+    vec4_t light_w;
+    vec4_t col          = vec4_from_scalar(0.f);
 
-    // specular
-    //      F * D * G
-    // ---------------------
-    // 4 * n_dot_l * n_dot_v
+    // only the lights that were binned in this tile
+    const light_tile_t* tile = light_grid_get(grid, x, y);
 
-    float d             = normal_dist(n_dot_h, rough);
-    float g             = self_shadow(n_dot_v, n_dot_l, rough);
-    vec4_t f            = fresnel(h_dot_v, albedo, metal);
-    float dg            = ( d * g ) / ( 4 * n_dot_l * n_dot_v + 0.001f );
-    vec4_t specular     = vec4_scale(f, dg);
+    for (uint32_t i = 0; i < tile->size; i++)
+    {
+        const light_t* light    = &lights[tile->indices[i]];
+        float attenuation       = light_attenuation(light, pos_w, &light_w);
 
-    // diffuse
-    //   kd * c
-    //  --------
-    //     pi
+        if (attenuation <= 0.f || vec4_dot(n_w, light_w) <= 0.f)
+        {
+            continue;
+        }
 
-    vec4_t kd           = vec4_sub(one, f);
-    kd                  = vec4_scale(kd, 1.f - metal);
-    kd                  = vec4_scale(kd, 1.f/F_PI);
-    vec4_t diffuse      = vec4_hadamard(albedo, kd);
+        if (shadows && tile->indices[i] == shadows->light)
+        {
+            attenuation        *= shadow_map_visibility(shadows, pos_w, n_w);
+        }
 
-    vec4_t col          = vec4_add(diffuse, specular);
-    col                 = vec4_scale(col, 1.f);
-    col                 = vec4_scale(col, n_dot_l);
+        vec4_t radiance         = vec4_scale(light->color, light->intensity * attenuation);
+        col                     = vec4_add(col, vec4_hadamard(brdf(n_w, view_w, light_w, albedo, rough, metal), radiance));
+    }
 
     // ambient + gamma correction
 
     vec4_t ambient      = vec4_scale(albedo, 0.1f);
+
+    if (environment)
+    {
+        ambient         = ambient_ibl(n_w, view_w, albedo, rough, metal);
+    }
+
+    // baked and screen space occlusion only darken the indirect light
+    if (ssao)
+    {
+        occlusion      *= ssao_occlusion(ssao, x, y);
+    }
+
+    ambient             = vec4_scale(ambient, occlusion);
+
     vec4_t final        = vec4_pow(vec4_add(col, ambient), one_over_gamma);
 
     return vec4_to_bgra(final);
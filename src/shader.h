@@ -2,12 +2,17 @@
 
 #include "camera.h"
 
+#include "ibl.h"
+#include "light.h"
+#include "shadow.h"
+#include "ssao.h"
 #include "texture.h"
 
 void        shader_set_uniforms(camera_t* cam,
                                 texture_t* albedo_tex,
                                 texture_t* metallic_tex,
                                 texture_t* normal_tex,
+                                texture_t* occlusion_tex,
                                 vec4_t v0, 
                                 vec4_t v1, 
                                 vec4_t v2,
@@ -17,5 +22,10 @@ void        shader_set_uniforms(camera_t* cam,
                                 vec4_t normal_vec0,
                                 vec4_t normal_vec1,
                                 vec4_t normal_vec2);
+void        shader_set_lights(const light_t* scene_lights, const light_grid_t* light_grid);
+void        shader_set_environment(const ibl_t* ibl);
+void        shader_set_shadows(const shadow_map_t* shadow_map);
+void        shader_set_ssao(const ssao_t* ambient_occlusion);
+void        shader_set_derivatives(vec4_t dw_dx, vec4_t dw_dy);
 vec4_t      shader_vertex(vec4_t v);
-uint32_t    shader_fragment(float w0, float w1, float w2);
+uint32_t    shader_fragment(uint32_t x, uint32_t y, float w0, float w1, float w2);
@@ -0,0 +1,286 @@
+#include "shadow.h"
+
+#include <math.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "rasterizer.h"
+
+/********************
+ *  Notes
+ *
+ * - Cascaded shadow maps   - https://learn.microsoft.com/en-us/windows/win32/dxtecharticles/cascaded-shadow-maps
+ * - Practical split scheme - https://developer.nvidia.com/gpugems/gpugems3/part-ii-light-and-shadows/chapter-10-parallel-split-shadow-maps-programmable-gpus
+ * - Normal offset bias     - https://www.dissidentlogic.com/old/images/NormalOffsetShadows/GDC_Poster_NormalOffset.png
+ *
+ * Only the first directional light casts shadows. The view frustum is split in SHADOW_CASCADES slices and each
+ * slice gets an orthographic shadow map fitted around its bounding sphere. The maps are rendered by the regular
+ * rasterizer without a framebuffer, which turns it into a depth only pass, and use the same reversed depth
+ * as the main pass (closest to the light = 1). Every cascade is rendered by its own thread while the main
+ * thread continues with the rest of the frame, shadow_map_render_end joins them before shading.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define SPLIT_LAMBDA        0.75f       // blend between logarithmic (1) and uniform (0) splits
+#define DEPTH_MARGIN        0.005f      // keeps the depth range inside the rasterizer's (0, 1] window
+#define NORMAL_OFFSET       1.5f        // texels
+#define DEPTH_BIAS          1.f         // texels
+#define PCF_RADIUS          1
+#define CASCADE_FORMAT      DEPTH_FORMAT_U16    // depth is linear, 16 bits resolve far finer than the bias
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static void cascade_fit(shadow_cascade_t* cascade,
+                        vec4_t dir,
+                        camera_t* cam,
+                        sphere_t scene,
+                        float split_near,
+                        float split_far,
+                        uint32_t size)
+{
+    // bounding sphere of the frustum slice
+    float tan_x         = cam->r_dist / cam->n_dist;
+    float tan_y         = cam->t_dist / cam->n_dist;
+    vec4_t c            = vec4_sub(cam->position_w, vec4_scale(cam->forward, (split_near + split_far) * 0.5f));
+    float r             = 0.f;
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        float d         = i & 4 ? split_far : split_near;
+        vec4_t corner   = vec4_sub(cam->position_w, vec4_scale(cam->forward, d));
+        corner          = vec4_add(corner, vec4_scale(cam->left,    i & 1 ? d * tan_x : -d * tan_x));
+        corner          = vec4_add(corner, vec4_scale(cam->up,      i & 2 ? d * tan_y : -d * tan_y));
+        r               = f_max(r, vec4_magnitude(vec4_sub(corner, c)));
+    }
+
+    // a slice larger than the scene only wastes resolution
+    if (r > scene.r)
+    {
+        c               = scene.c;
+        r               = scene.r;
+    }
+
+    // light basis, built like the camera basis so the rasterizer sees the same winding
+    vec4_t forward      = vec4_negate(dir);
+    vec4_t helper       = f_abs(forward.y) > 0.99f ? vec4_new(1.f, 0.f, 0.f) : vec4_new(0.f, 1.f, 0.f);
+    vec4_t left         = vec4_normalize(vec4_cross(helper, forward));
+    vec4_t up           = vec4_normalize(vec4_cross(forward, left));
+
+    // snap the center to whole texels so the shadow edges do not crawl when the camera moves
+    float texel         = 2.f * r / (float)size;
+    float cx            = f_floor(vec4_dot(c, left) / texel) * texel;
+    float cy            = f_floor(vec4_dot(c, up) / texel) * texel;
+
+    // depth covers everything in the scene that can cast a shadow
+    float t_min         = vec4_dot(scene.c, dir) - scene.r * 1.01f;
+    float t_max         = vec4_dot(scene.c, dir) + scene.r * 1.01f;
+    float k             = (1.f - 2.f * DEPTH_MARGIN) / (t_max - t_min);
+    float s             = (float)size / (2.f * r);
+    float half          = (float)size * 0.5f;
+
+    mat_t m             = mat_new_identity();
+
+    m.data[0][0]        = left.x * s;
+    m.data[0][1]        = left.y * s;
+    m.data[0][2]        = left.z * s;
+    m.data[0][3]        = half - cx * s;
+
+    // rows go down like the screen's
+    m.data[1][0]        = -up.x * s;
+    m.data[1][1]        = -up.y * s;
+    m.data[1][2]        = -up.z * s;
+    m.data[1][3]        = half + cy * s;
+
+    m.data[2][0]        = -dir.x * k;
+    m.data[2][1]        = -dir.y * k;
+    m.data[2][2]        = -dir.z * k;
+    m.data[2][3]        = DEPTH_MARGIN + t_max * k;
+
+    cascade->light_mat  = m;
+    cascade->split_far  = split_far;
+    cascade->texel_size = texel;
+    cascade->depth_bias = DEPTH_BIAS * texel * k;
+}
+
+static int32_t render_cascade(void* data)
+{
+    shadow_cascade_t* cascade   = (shadow_cascade_t*)data;
+    const mesh_t* mesh          = cascade->mesh;
+    mat_t M                     = cascade->light_mat;
+    uint32_t* indices           = mesh->indices;
+    vec4_t* vertices            = mesh->vertices;
+
+    depthbuffer_clear(cascade->depth);
+
+    for (uint32_t i = 0; i < mesh->indices_size; i += 3)
+    {
+        vec4_t v0 = mat_mul_vec(M, vertices[indices[i + 0]]);
+        vec4_t v1 = mat_mul_vec(M, vertices[indices[i + 1]]);
+        vec4_t v2 = mat_mul_vec(M, vertices[indices[i + 2]]);
+
+        // no framebuffer, depth only
+        rasterizer_draw_triangle(v0, v1, v2, NULL, cascade->depth);
+    }
+
+    return thrd_success;
+}
+
+/********************/
+/* public functions */
+/********************/
+
+shadow_map_t* shadow_map_new(uint32_t size)
+{
+    assert(size > 0);
+
+    shadow_map_t* shadow_map    = malloc(sizeof(shadow_map_t));
+    shadow_map->size            = size;
+    shadow_map->light           = MAX_LIGHTS;
+
+    for (uint32_t i = 0; i < SHADOW_CASCADES; i++)
+    {
+        shadow_map->cascades[i].depth   = depthbuffer_new(size, size);
+        depthbuffer_set_format(shadow_map->cascades[i].depth, CASCADE_FORMAT);
+        shadow_map->cascades[i].mesh    = NULL;
+    }
+
+    return shadow_map;
+}
+
+void shadow_map_render_begin(shadow_map_t* shadow_map,
+                             const light_t* lights,
+                             uint32_t lights_size,
+                             camera_t* cam,
+                             const mesh_t* mesh)
+{
+    shadow_map->light = MAX_LIGHTS;
+
+    for (uint32_t i = 0; i < lights_size; i++)
+    {
+        if (lights[i].type == DIRECTIONAL_LIGHT)
+        {
+            shadow_map->light = i;
+            break;
+        }
+    }
+
+    if (shadow_map->light == MAX_LIGHTS)
+    {
+        return;
+    }
+
+    vec4_t dir                  = lights[shadow_map->light].direction_w;
+    sphere_t scene              = mesh->bounding_sphere;
+    shadow_map->cam_w           = cam->position_w;
+    shadow_map->cam_forward     = cam->forward;
+
+    // nothing past the far side of the scene needs a shadow
+    float n                     = cam->n_dist;
+    float f                     = f_min(cam->f_dist, vec4_magnitude(vec4_sub(scene.c, cam->position_w)) + scene.r);
+    f                           = f_max(f, n * 2.f);
+    float split_near            = n;
+
+    for (uint32_t i = 0; i < SHADOW_CASCADES; i++)
+    {
+        float p                 = (float)(i + 1) / (float)SHADOW_CASCADES;
+        float log_split         = n * f_pow(f / n, p);
+        float uniform_split     = n + (f - n) * p;
+        float split_far         = SPLIT_LAMBDA * log_split + (1.f - SPLIT_LAMBDA) * uniform_split;
+
+        cascade_fit(&shadow_map->cascades[i], dir, cam, scene, split_near, split_far, shadow_map->size);
+
+        shadow_map->cascades[i].mesh = mesh;
+        split_near              = split_far;
+    }
+
+    int32_t success;
+
+    for (uint32_t i = 0; i < SHADOW_CASCADES; i++)
+    {
+        success = thrd_create(&shadow_map->threads[i], render_cascade, (void*)&shadow_map->cascades[i]);
+        assert(success == thrd_success);
+    }
+}
+
+void shadow_map_render_end(shadow_map_t* shadow_map)
+{
+    if (shadow_map->light == MAX_LIGHTS)
+    {
+        return;
+    }
+
+    int32_t success;
+
+    for (uint32_t i = 0; i < SHADOW_CASCADES; i++)
+    {
+        thrd_join(shadow_map->threads[i], &success);
+        assert(success == thrd_success);
+    }
+}
+
+float shadow_map_visibility(const shadow_map_t* shadow_map, vec4_t pos_w, vec4_t n_w)
+{
+    float view_depth    = vec4_dot(vec4_sub(shadow_map->cam_w, pos_w), shadow_map->cam_forward);
+    uint32_t i          = 0;
+
+    while (i < SHADOW_CASCADES && view_depth > shadow_map->cascades[i].split_far)
+    {
+        i++;
+    }
+
+    if (i == SHADOW_CASCADES)
+    {
+        return 1.f;
+    }
+
+    const shadow_cascade_t* cascade = &shadow_map->cascades[i];
+
+    // push the lookup along the normal to get rid of acne on surfaces at grazing angles
+    vec4_t offset_w     = vec4_add(pos_w, vec4_scale(n_w, NORMAL_OFFSET * cascade->texel_size));
+    vec4_t p            = mat_mul_vec(cascade->light_mat, offset_w);
+    int32_t size        = (int32_t)shadow_map->size;
+    int32_t px          = (int32_t)f_floor(p.x + 0.5f);
+    int32_t py          = (int32_t)f_floor(p.y + 0.5f);
+    float depth         = p.z + cascade->depth_bias;
+
+    if (px < 0 || py < 0 || px >= size || py >= size)
+    {
+        return 1.f;
+    }
+
+    // percentage closer filtering
+    float lit           = 0.f;
+    float taps          = 0.f;
+
+    for (int32_t y = py - PCF_RADIUS; y <= py + PCF_RADIUS; y++)
+    {
+        for (int32_t x = px - PCF_RADIUS; x <= px + PCF_RADIUS; x++)
+        {
+            uint32_t sx     = (uint32_t)(x < 0 ? 0 : (x >= size ? size - 1 : x));
+            uint32_t sy     = (uint32_t)(y < 0 ? 0 : (y >= size ? size - 1 : y));
+            lit            += depth >= depthbuffer_get(cascade->depth, sx, sy) ? 1.f : 0.f;
+            taps           += 1.f;
+        }
+    }
+
+    return lit / taps;
+}
+
+void shadow_map_free(shadow_map_t* shadow_map)
+{
+    for (uint32_t i = 0; i < SHADOW_CASCADES; i++)
+    {
+        depthbuffer_free(shadow_map->cascades[i].depth);
+    }
+
+    free(shadow_map);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <threads.h>
+
+#include "math.h"
+#include "mesh.h"
+#include "light.h"
+#include "camera.h"
+#include "depthbuffer.h"
+
+#define SHADOW_CASCADES     3
+#define SHADOW_MAP_SIZE     1024
+
+typedef struct
+{
+    mat_t           light_mat;      // world -> shadow map pixels (x, y) and reversed depth (z)
+    float           split_far;      // view depth at which the cascade ends
+    float           texel_size;     // world space size of a shadow map texel
+    float           depth_bias;
+    depthbuffer_t*  depth;
+    const mesh_t*   mesh;
+
+} shadow_cascade_t;
+
+typedef struct
+{
+    uint32_t            size;
+    uint32_t            light;      // index of the shadow casting light, MAX_LIGHTS if there is none
+    vec4_t              cam_w;
+    vec4_t              cam_forward;
+    shadow_cascade_t    cascades[SHADOW_CASCADES];
+    thrd_t              threads[SHADOW_CASCADES];
+
+} shadow_map_t;
+
+shadow_map_t*   shadow_map_new(uint32_t size);
+void            shadow_map_render_begin(shadow_map_t* shadow_map,
+                                        const light_t* lights,
+                                        uint32_t lights_size,
+                                        camera_t* cam,
+                                        const mesh_t* mesh);
+void            shadow_map_render_end(shadow_map_t* shadow_map);
+float           shadow_map_visibility(const shadow_map_t* shadow_map, vec4_t pos_w, vec4_t n_w);
+void            shadow_map_free(shadow_map_t* shadow_map);
@@ -0,0 +1,438 @@
+#include "ssao.h"
+
+#include <math.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <threads.h>
+
+#include "atomic_types.h"
+
+/********************
+ *  Notes
+ *
+ * - Crytek SSAO        - https://developer.download.nvidia.com/SDK/10.5/direct3d/Source/ScreenSpaceAO/doc/ScreenSpaceAO.pdf
+ * - LearnOpengl SSAO   - https://learnopengl.com/Advanced-Lighting/SSAO
+ * - Bilateral upsample - https://developer.nvidia.com/sites/default/files/akamai/gamedev/files/sdk/11/OpacityMappingSDKWhitePaper.pdf
+ *
+ * Post pass over the finished frame, the cost is bounded by working at half resolution:
+ *  1. the depthbuffer is point sampled down to half resolution and converted to linear depth
+ *  2. every half res pixel reconstructs its view space position and normal from the depth and tests
+ *     SSAO_KERNEL_SIZE hemisphere samples against it. The kernel is rotated with a 4x4 pattern
+ *  3. a separable, depth aware blur removes the pattern (horizontal + vertical pass)
+ *  4. the fragment shader upsamples the result with bilinear weights that ignore half res texels at a different
+ *     depth and scales the ambient term with it, in linear space before gamma
+ * The renderer runs a depth only prepass first so the occlusion is known before shading.
+ * Every pass is split in rows that a pool of SSAO_THREAD_COUNT workers picks up through an atomic index. The
+ * workers are started with the ssao buffers and sleep on a condition variable between passes.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define SSAO_STRENGTH       1.5f
+#define SSAO_BIAS           0.02f       // fraction of the radius
+#define BLUR_RADIUS         2
+#define DEPTH_SHARPNESS     50.f        // how fast the bilateral weights fall off with relative depth difference
+
+/********************/
+/* static variables */
+/********************/
+
+static const float blur_weights[BLUR_RADIUS * 2 + 1] = { 1.f, 4.f, 6.f, 4.f, 1.f };
+
+/********************/
+/* static functions */
+/********************/
+
+static float linear_depth(const ssao_t* ssao, float depth)
+{
+    // inverse of the reversed z projection, depth 0 is the cleared background
+    if (depth <= 0.f)
+    {
+        return 0.f;
+    }
+
+    float n = ssao->n_dist;
+    float f = ssao->f_dist;
+
+    return (n * f) / (depth * (f - n) + n);
+}
+
+static float depth_weight(float z0, float z1)
+{
+    return 1.f / (1.f + DEPTH_SHARPNESS * f_abs(z0 - z1) / z0);
+}
+
+static vec4_t view_position(const ssao_t* ssao, uint32_t x, uint32_t y)
+{
+    float z     = ssao->depth[y * ssao->width + x];
+    float ndc_x = 2.f * (float)x / (float)ssao->width - 1.f;
+    float ndc_y = 1.f - 2.f * (float)y / (float)ssao->height;
+
+    return vec4_new(ndc_x * z * ssao->tan_x, ndc_y * z * ssao->tan_y, -z);
+}
+
+// picks the neighbour on the side with the smaller depth step so edges do not bend the normal
+static vec4_t view_tangent(const ssao_t* ssao, vec4_t p, uint32_t x, uint32_t y, int32_t dx, int32_t dy)
+{
+    int32_t w       = (int32_t)ssao->width;
+    int32_t h       = (int32_t)ssao->height;
+    int32_t x0      = (int32_t)x - dx;
+    int32_t y0      = (int32_t)y - dy;
+    int32_t x1      = (int32_t)x + dx;
+    int32_t y1      = (int32_t)y + dy;
+    bool has_prev   = x0 >= 0 && y0 >= 0 && ssao->depth[y0 * w + x0] > 0.f;
+    bool has_next   = x1 < w && y1 < h && ssao->depth[y1 * w + x1] > 0.f;
+
+    vec4_t prev     = has_prev ? vec4_sub(p, view_position(ssao, (uint32_t)x0, (uint32_t)y0)) : vec4_from_scalar(0.f);
+    vec4_t next     = has_next ? vec4_sub(view_position(ssao, (uint32_t)x1, (uint32_t)y1), p) : vec4_from_scalar(0.f);
+
+    if (!has_prev || (has_next && f_abs(next.z) < f_abs(prev.z)))
+    {
+        return next;
+    }
+
+    return prev;
+}
+
+static void downsample_row(ssao_t* ssao, uint32_t y)
+{
+    for (uint32_t x = 0; x < ssao->width; x++)
+    {
+        float depth = depthbuffer_get(ssao->depthbuffer, x * 2, y * 2);
+        ssao->depth[y * ssao->width + x] = linear_depth(ssao, depth);
+    }
+}
+
+static void occlusion_row(ssao_t* ssao, uint32_t y)
+{
+    float w         = (float)ssao->width;
+    float h         = (float)ssao->height;
+    float radius    = ssao->radius;
+
+    for (uint32_t x = 0; x < ssao->width; x++)
+    {
+        uint32_t i  = y * ssao->width + x;
+
+        if (ssao->depth[i] <= 0.f)
+        {
+            ssao->ao[i] = 1.f;
+            continue;
+        }
+
+        vec4_t p        = view_position(ssao, x, y);
+        vec4_t n        = vec4_cross(view_tangent(ssao, p, x, y, 1, 0), view_tangent(ssao, p, x, y, 0, 1));
+
+        if (vec4_magnitude_sq(n) == 0.f)
+        {
+            ssao->ao[i] = 1.f;
+            continue;
+        }
+
+        // face the camera
+        n               = vec4_normalize(n);
+        n               = vec4_dot(n, p) > 0.f ? vec4_negate(n) : n;
+
+        // rotate the kernel with a 4x4 pattern, the blur removes it again
+        float angle     = (float)((x & 3) * 4 + (y & 3)) * (2.f * F_PI / 16.f);
+        vec4_t r        = vec4_new(f_cos(angle), f_sin(angle), 0.f);
+        vec4_t t        = vec4_sub(r, vec4_scale(n, vec4_dot(r, n)));
+
+        if (vec4_magnitude_sq(t) < 0.0001f)
+        {
+            t           = vec4_new(0.f, 0.f, 1.f);
+            t           = vec4_sub(t, vec4_scale(n, vec4_dot(t, n)));
+        }
+
+        t               = vec4_normalize(t);
+        vec4_t b        = vec4_cross(n, t);
+        float occlusion = 0.f;
+
+        for (uint32_t k = 0; k < SSAO_KERNEL_SIZE; k++)
+        {
+            vec4_t kernel   = ssao->kernel[k];
+            vec4_t s        = vec4_add(p, vec4_scale(t, kernel.x * radius));
+            s               = vec4_add(s, vec4_scale(b, kernel.y * radius));
+            s               = vec4_add(s, vec4_scale(n, kernel.z * radius));
+
+            if (s.z >= 0.f)
+            {
+                continue;
+            }
+
+            // project the sample back to the half res buffer
+            float sx        = (s.x / (-s.z * ssao->tan_x) + 1.f) * 0.5f * w;
+            float sy        = (1.f - s.y / (-s.z * ssao->tan_y)) * 0.5f * h;
+
+            if (sx < 0.f || sy < 0.f || sx >= w || sy >= h)
+            {
+                continue;
+            }
+
+            float scene_z   = ssao->depth[(uint32_t)sy * ssao->width + (uint32_t)sx];
+
+            if (scene_z > 0.f && scene_z < -s.z - SSAO_BIAS * radius)
+            {
+                // range check, distant occluders do not count
+                float range = f_clamp(radius / f_abs(-p.z - scene_z), 0.f, 1.f);
+                occlusion  += range * range;
+            }
+        }
+
+        ssao->ao[i] = f_clamp(1.f - SSAO_STRENGTH * occlusion / (float)SSAO_KERNEL_SIZE, 0.f, 1.f);
+    }
+}
+
+static void blur_row(const ssao_t* ssao, const float* src, float* dst, uint32_t y, int32_t dx, int32_t dy)
+{
+    int32_t w = (int32_t)ssao->width;
+    int32_t h = (int32_t)ssao->height;
+
+    for (int32_t x = 0; x < w; x++)
+    {
+        int32_t i   = (int32_t)y * w + x;
+        float z     = ssao->depth[i];
+
+        if (z <= 0.f)
+        {
+            dst[i]  = 1.f;
+            continue;
+        }
+
+        float sum   = 0.f;
+        float total = 0.f;
+
+        for (int32_t k = -BLUR_RADIUS; k <= BLUR_RADIUS; k++)
+        {
+            int32_t sx  = x + k * dx;
+            int32_t sy  = (int32_t)y + k * dy;
+
+            if (sx < 0 || sy < 0 || sx >= w || sy >= h || ssao->depth[sy * w + sx] <= 0.f)
+            {
+                continue;
+            }
+
+            float weight    = blur_weights[k + BLUR_RADIUS] * depth_weight(z, ssao->depth[sy * w + sx]);
+            sum            += src[sy * w + sx] * weight;
+            total          += weight;
+        }
+
+        dst[i]      = sum / total;
+    }
+}
+
+static void blur_horizontal_row(ssao_t* ssao, uint32_t y)
+{
+    blur_row(ssao, ssao->ao, ssao->temp, y, 1, 0);
+}
+
+static void blur_vertical_row(ssao_t* ssao, uint32_t y)
+{
+    blur_row(ssao, ssao->temp, ssao->ao, y, 0, 1);
+}
+
+static int32_t run_worker(void* data)
+{
+    ssao_t* ssao    = (ssao_t*)data;
+    uint32_t pass   = 0;
+
+    mtx_lock(&ssao->lock);
+
+    while (true)
+    {
+        while (!ssao->quit && ssao->pass == pass)
+        {
+            cnd_wait(&ssao->work, &ssao->lock);
+        }
+
+        if (ssao->quit)
+        {
+            break;
+        }
+
+        pass            = ssao->pass;
+        mtx_unlock(&ssao->lock);
+
+        uint32_t row    = ssao->next_row++;
+
+        while (row < ssao->rows)
+        {
+            ssao->func(ssao, row);
+            row         = ssao->next_row++;
+        }
+
+        mtx_lock(&ssao->lock);
+
+        if (--ssao->busy == 0)
+        {
+            cnd_signal(&ssao->done);
+        }
+    }
+
+    mtx_unlock(&ssao->lock);
+
+    return thrd_success;
+}
+
+static void run_pass(ssao_t* ssao, void (*func)(ssao_t* ssao, uint32_t row), uint32_t rows)
+{
+    mtx_lock(&ssao->lock);
+
+    ssao->func      = func;
+    ssao->rows      = rows;
+    ssao->next_row  = 0;
+    ssao->busy      = SSAO_THREAD_COUNT;
+    ssao->pass++;
+
+    cnd_broadcast(&ssao->work);
+
+    while (ssao->busy > 0)
+    {
+        cnd_wait(&ssao->done, &ssao->lock);
+    }
+
+    mtx_unlock(&ssao->lock);
+}
+
+/********************/
+/* public functions */
+/********************/
+
+ssao_t* ssao_new(uint32_t width, uint32_t height)
+{
+    assert(width > 1 && height > 1);
+
+    ssao_t* ssao    = malloc(sizeof(ssao_t));
+    ssao->width     = width / 2;
+    ssao->height    = height / 2;
+    ssao->depth     = malloc(sizeof(float) * ssao->width * ssao->height);
+    ssao->ao        = malloc(sizeof(float) * ssao->width * ssao->height);
+    ssao->temp      = malloc(sizeof(float) * ssao->width * ssao->height);
+
+    // spiral over the hemisphere, samples are pulled towards the center
+    for (uint32_t i = 0; i < SSAO_KERNEL_SIZE; i++)
+    {
+        float t         = ((float)i + 0.5f) / (float)SSAO_KERNEL_SIZE;
+        float cos_theta = 1.f - t * 0.9f;
+        float sin_theta = sqrtf(1.f - cos_theta * cos_theta);
+        float phi       = (float)i * 2.3999632f;
+        float scale     = 0.1f + 0.9f * t * t;
+
+        ssao->kernel[i] = vec4_new(sin_theta * f_cos(phi) * scale,
+                                   sin_theta * f_sin(phi) * scale,
+                                   cos_theta * scale);
+    }
+
+    ssao->pass      = 0;
+    ssao->busy      = 0;
+    ssao->quit      = false;
+    ssao->func      = NULL;
+    ssao->rows      = 0;
+    ssao->next_row  = 0;
+
+    int32_t success = mtx_init(&ssao->lock, mtx_plain);
+    assert(success == thrd_success);
+
+    success         = cnd_init(&ssao->work);
+    assert(success == thrd_success);
+
+    success         = cnd_init(&ssao->done);
+    assert(success == thrd_success);
+
+    for (uint32_t i = 0; i < SSAO_THREAD_COUNT; i++)
+    {
+        success     = thrd_create(&ssao->threads[i], run_worker, (void*)ssao);
+        assert(success == thrd_success);
+    }
+
+    return ssao;
+}
+
+void ssao_compute(ssao_t* ssao, depthbuffer_t* depthbuffer, camera_t* cam, float radius)
+{
+    assert(depthbuffer->width / 2 == ssao->width && depthbuffer->height / 2 == ssao->height);
+
+    ssao->depthbuffer   = depthbuffer;
+    ssao->radius        = radius;
+    ssao->n_dist        = cam->n_dist;
+    ssao->f_dist        = cam->f_dist;
+    ssao->tan_x         = cam->r_dist / cam->n_dist;
+    ssao->tan_y         = cam->t_dist / cam->n_dist;
+
+    run_pass(ssao, downsample_row,      ssao->height);
+    run_pass(ssao, occlusion_row,       ssao->height);
+    run_pass(ssao, blur_horizontal_row, ssao->height);
+    run_pass(ssao, blur_vertical_row,   ssao->height);
+}
+
+float ssao_occlusion(const ssao_t* ssao, uint32_t x, uint32_t y)
+{
+    float z             = linear_depth(ssao, depthbuffer_get(ssao->depthbuffer, x, y));
+
+    if (z <= 0.f)
+    {
+        return 1.f;
+    }
+
+    uint32_t w          = ssao->width;
+    uint32_t h          = ssao->height;
+    uint32_t hx0        = u_min(x / 2, w - 1);
+    uint32_t hx1        = u_min(hx0 + 1, w - 1);
+    uint32_t hy0        = u_min(y / 2, h - 1);
+    uint32_t hy1        = u_min(hy0 + 1, h - 1);
+    float fx            = (x & 1) ? 0.5f : 0.f;
+    float fy            = (y & 1) ? 0.5f : 0.f;
+
+    uint32_t idx[4]     = { hy0 * w + hx0, hy0 * w + hx1, hy1 * w + hx0, hy1 * w + hx1 };
+    float bilinear[4]   = { (1.f - fx) * (1.f - fy), fx * (1.f - fy), (1.f - fx) * fy, fx * fy };
+    float sum           = 0.f;
+    float total         = 0.f;
+
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        float hz        = ssao->depth[idx[k]];
+
+        if (hz <= 0.f)
+        {
+            continue;
+        }
+
+        float weight    = (bilinear[k] + 0.001f) * depth_weight(z, hz);
+        sum            += ssao->ao[idx[k]] * weight;
+        total          += weight;
+    }
+
+    if (total <= 0.f)
+    {
+        return 1.f;
+    }
+
+    return f_clamp(sum / total, 0.f, 1.f);
+}
+
+void ssao_free(ssao_t* ssao)
+{
+    mtx_lock(&ssao->lock);
+    ssao->quit = true;
+    cnd_broadcast(&ssao->work);
+    mtx_unlock(&ssao->lock);
+
+    int32_t success;
+
+    for (uint32_t i = 0; i < SSAO_THREAD_COUNT; i++)
+    {
+        thrd_join(ssao->threads[i], &success);
+        assert(success == thrd_success);
+    }
+
+    cnd_destroy(&ssao->work);
+    cnd_destroy(&ssao->done);
+    mtx_destroy(&ssao->lock);
+
+    free(ssao->depth);
+    free(ssao->ao);
+    free(ssao->temp);
+    free(ssao);
+}
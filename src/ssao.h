@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <threads.h>
+
+#include "camera.h"
+#include "depthbuffer.h"
+#include "atomic_types.h"
+
+#define SSAO_KERNEL_SIZE    12
+#define SSAO_THREAD_COUNT   4
+
+typedef struct ssao
+{
+    uint32_t    width;                          // half of the framebuffer resolution
+    uint32_t    height;
+    float*      depth;                          // linear view depth, 0 for the background
+    float*      ao;
+    float*      temp;                           // horizontal blur result
+    vec4_t      kernel[SSAO_KERNEL_SIZE];       // tangent space hemisphere samples
+
+    // per frame state
+    depthbuffer_t*  depthbuffer;
+    float           radius;
+    float           n_dist;
+    float           f_dist;
+    float           tan_x;
+    float           tan_y;
+
+    // worker pool, lives as long as the ssao buffers
+    thrd_t              threads[SSAO_THREAD_COUNT];
+    mtx_t               lock;
+    cnd_t               work;                   // a new pass or quit
+    cnd_t               done;                   // the last worker finished the pass
+    uint32_t            pass;                   // incremented for every pass
+    uint32_t            busy;                   // workers still in the current pass
+    bool                quit;
+    void                (*func)(struct ssao* ssao, uint32_t row);
+    uint32_t            rows;
+    atomic_uint32_t     next_row;
+
+} ssao_t;
+
+ssao_t* ssao_new(uint32_t width, uint32_t height);
+
+// occlusion of the depthbuffer at half resolution, depth has to be final (depth prepass)
+void    ssao_compute(ssao_t* ssao, depthbuffer_t* depthbuffer, camera_t* cam, float radius);
+
+// bilateral upsample of the computed occlusion at a full resolution pixel, 1 is unoccluded
+float   ssao_occlusion(const ssao_t* ssao, uint32_t x, uint32_t y);
+
+void    ssao_free(ssao_t* ssao);
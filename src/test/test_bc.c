@@ -0,0 +1,95 @@
+#include "test_bc.h"
+
+#include <stdlib.h>
+
+#include "test_utils.h"
+#include "../bc.h"
+
+static void test_bc1_round_trip()
+{
+    // gradient along one axis is represented by the 4 palette entries within 565 precision
+    unsigned char rgb[BC_BLOCK_TEXELS * 3];
+    unsigned char decoded[BC_BLOCK_TEXELS * 3];
+    unsigned char block[BC1_BLOCK_BYTES];
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        rgb[i * 3 + 0] = (unsigned char)(40 + (i % 4) * 60);
+        rgb[i * 3 + 1] = (unsigned char)(200 - (i % 4) * 60);
+        rgb[i * 3 + 2] = 80;
+    }
+
+    bc1_encode(rgb, block);
+    bc1_decode(block, decoded);
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS * 3; i++)
+    {
+        ASSERT_TRUE(abs((int32_t)rgb[i] - (int32_t)decoded[i]) <= 6);
+    }
+
+    // a flat block keeps its color
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS * 3; i++)
+    {
+        rgb[i] = 255;
+    }
+
+    bc1_encode(rgb, block);
+    bc1_decode(block, decoded);
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS * 3; i++)
+    {
+        ASSERT_EQUAL((uint32_t)decoded[i], 255);
+    }
+}
+
+static void test_bc4_round_trip()
+{
+    // two values are the endpoints and decode exactly, everything else is within half a palette step
+    unsigned char values[BC_BLOCK_TEXELS];
+    unsigned char decoded[BC_BLOCK_TEXELS];
+    unsigned char block[BC4_BLOCK_BYTES];
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        values[i] = (unsigned char)(i * 17);
+    }
+
+    bc4_encode(values, block);
+    bc4_decode(block, decoded);
+
+    ASSERT_EQUAL((uint32_t)decoded[0], 0);
+    ASSERT_EQUAL((uint32_t)decoded[15], 255);
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        ASSERT_TRUE(abs((int32_t)values[i] - (int32_t)decoded[i]) <= 19);
+    }
+}
+
+static void test_bc5_round_trip()
+{
+    unsigned char rg[BC_BLOCK_TEXELS * 2];
+    unsigned char decoded[BC_BLOCK_TEXELS * 2];
+    unsigned char block[BC5_BLOCK_BYTES];
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+    {
+        rg[i * 2 + 0] = i % 2 ? 10 : 250;
+        rg[i * 2 + 1] = 128;
+    }
+
+    bc5_encode(rg, block);
+    bc5_decode(block, decoded);
+
+    for (uint32_t i = 0; i < BC_BLOCK_TEXELS * 2; i++)
+    {
+        ASSERT_EQUAL((uint32_t)decoded[i], (uint32_t)rg[i]);
+    }
+}
+
+void test_bc()
+{
+    TEST_CASE(test_bc1_round_trip);
+    TEST_CASE(test_bc4_round_trip);
+    TEST_CASE(test_bc5_round_trip);
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_bc();
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "test_frame_queue.h"
+
+#include <threads.h>
+
+#include "test_utils.h"
+#include "../frame_queue.h"
+
+#define TRANSFER_FRAMES 10000
+
+static int32_t produce_frames(void* data)
+{
+    frame_queue_t* queue = data;
+
+    for (uint32_t i = 1; i <= TRANSFER_FRAMES; i++)
+    {
+        frame_t frame = { .framebuffer = NULL, .submitted = (timestamp_t)i };
+
+        while (!frame_queue_push(queue, frame))
+        {
+            thrd_yield();
+        }
+    }
+
+    return thrd_success;
+}
+
+static void test_order()
+{
+    framebuffer_t framebuffers[FRAME_QUEUE_SIZE];
+    frame_queue_t* queue        = frame_queue_new();
+    frame_t frame;
+
+    ASSERT_FALSE(frame_queue_pop(queue, &frame));
+
+    // more pushes than slots, the indices wrap around the ring
+    for (uint32_t round = 0; round < 3; round++)
+    {
+        for (uint32_t i = 0; i < FRAME_QUEUE_SIZE; i++)
+        {
+            frame_t pushed = { .framebuffer = &framebuffers[i], .submitted = (timestamp_t)i };
+            ASSERT_TRUE(frame_queue_push(queue, pushed));
+        }
+
+        frame_t overflow = { .framebuffer = NULL, .submitted = 0 };
+        ASSERT_FALSE(frame_queue_push(queue, overflow));
+        ASSERT_EQUAL(frame_queue_size(queue), FRAME_QUEUE_SIZE);
+
+        for (uint32_t i = 0; i < FRAME_QUEUE_SIZE; i++)
+        {
+            ASSERT_TRUE(frame_queue_pop(queue, &frame));
+            ASSERT_POINTER(frame.framebuffer, &framebuffers[i]);
+            ASSERT_TRUE(frame.submitted == (timestamp_t)i);
+        }
+
+        ASSERT_FALSE(frame_queue_pop(queue, &frame));
+        ASSERT_EQUAL(frame_queue_size(queue), 0);
+    }
+
+    frame_queue_free(queue);
+}
+
+static void test_threads()
+{
+    frame_queue_t* queue    = frame_queue_new();
+    thrd_t producer;
+
+    thrd_create(&producer, produce_frames, queue);
+
+    // frames arrive complete and in order
+    timestamp_t expected    = 1;
+    frame_t frame;
+
+    while (expected <= TRANSFER_FRAMES)
+    {
+        if (frame_queue_pop(queue, &frame))
+        {
+            ASSERT_TRUE(frame.submitted == expected);
+            expected++;
+        }
+        else
+        {
+            thrd_yield();
+        }
+    }
+
+    thrd_join(producer, NULL);
+    ASSERT_FALSE(frame_queue_pop(queue, &frame));
+
+    frame_queue_free(queue);
+}
+
+void test_frame_queue()
+{
+    TEST_CASE(test_order);
+    TEST_CASE(test_threads);
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_frame_queue();
\ No newline at end of file
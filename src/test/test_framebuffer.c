@@ -0,0 +1,274 @@
+#include "test_framebuffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../framebuffer.h"
+#include "../depthbuffer.h"
+
+static void test_wrapped_pitch()
+{
+    // 4x3 pixels in rows of 5, the padding pixel of each row is never touched
+    uint32_t memory[5 * 3];
+    memset(memory, 7, sizeof(memory));
+
+    framebuffer_t* frame    = framebuffer_wrap(4, 3, 5, memory);
+    ASSERT_FALSE(frame->owned);
+
+    framebuffer_clear(frame);
+    framebuffer_set(frame, 1, 0, 0x00112233);
+    framebuffer_set(frame, 3, 2, 0x00AABBCC);
+
+    ASSERT_EQUAL(framebuffer_get(frame, 1, 0), 0x00112233);
+    ASSERT_EQUAL(framebuffer_get(frame, 3, 2), 0x00AABBCC);
+
+    // y = 0 is the first row in memory, blue is the first byte of a pixel
+    ASSERT_EQUAL(memory[0 * 5 + 1], 0x00112233);
+    ASSERT_EQUAL(memory[2 * 5 + 3], 0x00AABBCC);
+    ASSERT_EQUAL((uint32_t)((unsigned char*)memory)[(0 * 5 + 1) * 4], 0x33);
+
+    for (uint32_t y = 0; y < 3; y++)
+    {
+        ASSERT_EQUAL(memory[y * 5 + 4], 0x07070707);
+    }
+
+    framebuffer_free(frame);
+}
+
+static void test_owned_buffer()
+{
+    framebuffer_t* frame    = framebuffer_new(8, 2);
+
+    ASSERT_TRUE(frame->owned);
+    ASSERT_EQUAL(frame->pitch, 8);
+
+    framebuffer_set(frame, 7, 1, 0x01020304);
+    ASSERT_EQUAL(framebuffer_get(frame, 7, 1), 0x01020304);
+
+    framebuffer_free(frame);
+}
+
+static void test_write_span()
+{
+    framebuffer_t* frame    = framebuffer_new(8, 2);
+    uint32_t colors[3]      = { 0x00FF0000, 0x0000FF00, 0x000000FF };
+
+    framebuffer_clear(frame);
+    framebuffer_write_span(frame, 5, 1, colors, 3);
+
+    ASSERT_EQUAL(framebuffer_get(frame, 4, 1), 0x78787878);
+    ASSERT_EQUAL(framebuffer_get(frame, 5, 1), 0x00FF0000);
+    ASSERT_EQUAL(framebuffer_get(frame, 6, 1), 0x0000FF00);
+    ASSERT_EQUAL(framebuffer_get(frame, 7, 1), 0x000000FF);
+    ASSERT_EQUAL(framebuffer_get(frame, 5, 0), 0x78787878);
+
+    framebuffer_free(frame);
+}
+
+static void test_tiled_layout()
+{
+    // 21x10 does not fill the last tiles
+    framebuffer_t* tiled    = framebuffer_new(21, 10);
+    framebuffer_t* linear   = framebuffer_new(21, 10);
+    uint32_t colors[15];
+
+    for (uint32_t i = 0; i < 15; i++)
+    {
+        colors[i] = 0x00010000 * i + 5;
+    }
+
+    framebuffer_set(tiled, 20, 9, 0x00ABCDEF);
+    framebuffer_set_layout(tiled, FRAMEBUFFER_LAYOUT_TILED);
+
+    // pixels survive the layout change, spans are split at tile edges
+    ASSERT_EQUAL(framebuffer_get(tiled, 20, 9), 0x00ABCDEF);
+    ASSERT_EQUAL(tiled->data[(1 * tiled->tiles_x + 2) * 64 + 1 * 8 + 4], 0x00ABCDEF);
+
+    framebuffer_write_span(tiled, 3, 7, colors, 15);
+    framebuffer_write_span(linear, 3, 7, colors, 15);
+    framebuffer_set(linear, 20, 9, 0x00ABCDEF);
+
+    for (uint32_t x = 0; x < 21; x++)
+    {
+        ASSERT_EQUAL(framebuffer_get(tiled, x, 7), framebuffer_get(linear, x, 7));
+    }
+
+    // detiled into a padded image, the padding is never touched
+    uint32_t memory[24 * 10] = { 0 };
+    framebuffer_t* image    = framebuffer_wrap(21, 10, 24, memory);
+    framebuffer_detile(tiled, image);
+
+    for (uint32_t y = 0; y < 10; y++)
+    {
+        for (uint32_t x = 0; x < 21; x++)
+        {
+            ASSERT_EQUAL(framebuffer_get(image, x, y), framebuffer_get(linear, x, y));
+        }
+
+        ASSERT_EQUAL(memory[y * 24 + 21], 0);
+    }
+
+    framebuffer_free(image);
+    framebuffer_free(linear);
+    framebuffer_free(tiled);
+}
+
+static void test_tiled_depth()
+{
+    depthbuffer_t* depth = depthbuffer_new(13, 9);
+
+    depthbuffer_set(depth, 12, 8, 0.5f);
+    depthbuffer_set_layout(depth, FRAMEBUFFER_LAYOUT_TILED);
+
+    ASSERT_EQUAL(depthbuffer_get(depth, 12, 8), 0.5f);
+    ASSERT_EQUAL(depthbuffer_get(depth, 0, 0), 0.f);
+
+    // the second tile starts after the 64 values of the first
+    depthbuffer_set(depth, 9, 1, 0.25f);
+    ASSERT_EQUAL(depth->data[1 * 64 + 1 * 8 + 1], 0.25f);
+
+    // flagged only, the value stays in memory until the tile is written again
+    depthbuffer_clear(depth);
+    ASSERT_EQUAL(depthbuffer_get(depth, 9, 1), 0.f);
+    ASSERT_EQUAL(depth->data[1 * 64 + 1 * 8 + 1], 0.25f);
+
+    depthbuffer_set(depth, 8, 0, 1.f);
+    ASSERT_EQUAL(depth->data[1 * 64 + 1 * 8 + 1], 0.f);
+
+    depthbuffer_free(depth);
+}
+
+static void test_lazy_clear()
+{
+    // 12x10 is 2x2 tiles, the right and bottom ones partial
+    uint32_t memory[12 * 10];
+    memset(memory, 7, sizeof(memory));
+
+    framebuffer_t* frame    = framebuffer_wrap(12, 10, 12, memory);
+    framebuffer_clear(frame);
+
+    // flagged only, reads return the clear colour
+    ASSERT_EQUAL(memory[0], 0x07070707);
+    ASSERT_EQUAL(framebuffer_get(frame, 0, 0), FRAMEBUFFER_CLEAR_COLOR);
+
+    // the first write fills its tile and nothing else
+    framebuffer_set(frame, 9, 2, 0x00123456);
+    ASSERT_EQUAL(memory[0 * 12 + 11], FRAMEBUFFER_CLEAR_COLOR);
+    ASSERT_EQUAL(memory[2 * 12 + 9], 0x00123456);
+    ASSERT_EQUAL(memory[0 * 12 + 7], 0x07070707);
+    ASSERT_EQUAL(memory[9 * 12 + 11], 0x07070707);
+
+    // the rest is filled before presenting
+    framebuffer_resolve_clear(frame);
+
+    for (uint32_t i = 0; i < 12 * 10; i++)
+    {
+        ASSERT_TRUE(memory[i] == (i == 2 * 12 + 9 ? 0x00123456 : FRAMEBUFFER_CLEAR_COLOR));
+    }
+
+    framebuffer_free(frame);
+}
+
+static void test_upscale()
+{
+    // a 2x1 frame on a 4x2 window, pixel centres 0.25 and 0.75 of the way between the two source pixels
+    framebuffer_t* source   = framebuffer_new(2, 1);
+    framebuffer_t* target   = framebuffer_new(4, 2);
+    framebuffer_set(source, 0, 0, 0x00000000);
+    framebuffer_set(source, 1, 0, 0xC8C8C8C8);
+
+    framebuffer_upscale_table_t* table = framebuffer_upscale_table_new(source, target);
+    framebuffer_upscale(table, source, target);
+
+    for (uint32_t y = 0; y < 2; y++)
+    {
+        ASSERT_EQUAL(framebuffer_get(target, 0, y), 0x00000000);
+        ASSERT_EQUAL(framebuffer_get(target, 1, y), 0x32323232);
+        ASSERT_EQUAL(framebuffer_get(target, 2, y), 0x96969696);
+        ASSERT_EQUAL(framebuffer_get(target, 3, y), 0xC8C8C8C8);
+    }
+
+    // the table is reused for every frame of the same size
+    framebuffer_set(source, 0, 0, 0xC8C8C8C8);
+    framebuffer_set(source, 1, 0, 0x00000000);
+    framebuffer_upscale(table, source, target);
+
+    ASSERT_EQUAL(framebuffer_get(target, 1, 1), 0x96969696);
+    ASSERT_EQUAL(framebuffer_get(target, 2, 1), 0x32323232);
+
+    framebuffer_upscale_table_free(table);
+    framebuffer_free(source);
+    framebuffer_free(target);
+
+    // the same size is a copy, from either layout, tiles never drawn to get the clear colour
+    source                  = framebuffer_new(12, 10);
+    target                  = framebuffer_new(12, 10);
+    framebuffer_set_layout(source, FRAMEBUFFER_LAYOUT_TILED);
+    framebuffer_clear(source);
+
+    for (uint32_t y = 0; y < 8; y++)
+    {
+        for (uint32_t x = 0; x < 12; x++)
+        {
+            framebuffer_set(source, x, y, y * 12 + x);
+        }
+    }
+
+    table                   = framebuffer_upscale_table_new(source, target);
+    framebuffer_upscale(table, source, target);
+
+    for (uint32_t y = 0; y < 10; y++)
+    {
+        for (uint32_t x = 0; x < 12; x++)
+        {
+            ASSERT_TRUE(target->data[y * 12 + x] == (y < 8 ? y * 12 + x : FRAMEBUFFER_CLEAR_COLOR));
+        }
+    }
+
+    framebuffer_upscale_table_free(table);
+    framebuffer_free(source);
+    framebuffer_free(target);
+}
+
+static void test_depth_formats()
+{
+    depthbuffer_t* depth = depthbuffer_new(16, 8);
+
+    depthbuffer_set(depth, 3, 2, 0.75f);
+    depthbuffer_set_format(depth, DEPTH_FORMAT_U16);
+
+    // converted values survive within a step of the format
+    ASSERT_EQUAL((uint32_t)depth->data_u16[2 * 16 + 3], 49151);
+    ASSERT_TRUE(f_abs(depthbuffer_get(depth, 3, 2) - 0.75f) < 1.f / 65535.f);
+
+    // nearer is larger, equal passes, the test compares quantized values
+    ASSERT_TRUE(depthbuffer_test(depth, 3, 2, 0.75f));
+    ASSERT_FALSE(depthbuffer_test(depth, 3, 2, 0.7f));
+    ASSERT_TRUE(depthbuffer_test(depth, 3, 2, 0.8f));
+    ASSERT_EQUAL((uint32_t)depth->data_u16[2 * 16 + 3], 52428);
+
+    // cleared to the far plane
+    depthbuffer_clear(depth);
+    ASSERT_EQUAL(depthbuffer_get(depth, 3, 2), 0.f);
+    ASSERT_TRUE(depthbuffer_test(depth, 9, 6, 0.000001f));
+
+    depthbuffer_set_format(depth, DEPTH_FORMAT_U24);
+    ASSERT_TRUE(depthbuffer_test(depth, 0, 0, 0.5f));
+    ASSERT_EQUAL(depth->data_u24[0], 0x800000);
+    ASSERT_FALSE(depthbuffer_test(depth, 0, 0, 0.49999f));
+
+    depthbuffer_free(depth);
+}
+
+void test_framebuffer()
+{
+    TEST_CASE(test_wrapped_pitch);
+    TEST_CASE(test_owned_buffer);
+    TEST_CASE(test_write_span);
+    TEST_CASE(test_tiled_layout);
+    TEST_CASE(test_tiled_depth);
+    TEST_CASE(test_lazy_clear);
+    TEST_CASE(test_upscale);
+    TEST_CASE(test_depth_formats);
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_framebuffer();
\ No newline at end of file
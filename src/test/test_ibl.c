@@ -0,0 +1,79 @@
+#include "test_ibl.h"
+
+#include "test_utils.h"
+#include "../ibl.h"
+
+static ibl_t* create_constant_ibl(unsigned char value)
+{
+    texture_t* texture = texture_new(64, 32, 3, TEXTURE_LAYOUT_LINEAR);
+
+    for (uint32_t i = 0; i < 64 * 32 * 3; i++)
+    {
+        texture->data[i] = value;
+    }
+
+    ibl_t* ibl = ibl_compute(texture);
+    texture_free(texture);
+
+    return ibl;
+}
+
+static void test_constant_irradiance()
+{
+    ibl_t* ibl      = create_constant_ibl(255);
+    vec4_t up       = ibl_irradiance(ibl, vec4_new(0.f, 1.f, 0.f));
+    vec4_t side     = ibl_irradiance(ibl, vec4_new(1.f, 0.f, 0.f));
+
+    ASSERT_TRUE(f_abs(up.x - 1.f) < 0.01f);
+    ASSERT_TRUE(f_abs(up.y - 1.f) < 0.01f);
+    ASSERT_TRUE(f_abs(up.z - 1.f) < 0.01f);
+    ASSERT_TRUE(f_abs(side.x - 1.f) < 0.01f);
+
+    ibl_free(ibl);
+}
+
+static void test_constant_specular()
+{
+    ibl_t* ibl      = create_constant_ibl(255);
+
+    for (uint32_t i = 0; i <= 4; i++)
+    {
+        float roughness = (float)i / 4.f;
+        vec4_t s        = ibl_specular(ibl, vec4_new(0.f, 0.f, 1.f), roughness);
+
+        ASSERT_TRUE(f_abs(s.x - 1.f) < 0.01f);
+        ASSERT_TRUE(f_abs(s.z - 1.f) < 0.01f);
+    }
+
+    ibl_free(ibl);
+}
+
+static void test_brdf_lut()
+{
+    ibl_t* ibl      = create_constant_ibl(0);
+    vec2_t smooth   = ibl_brdf(ibl, 1.f, 0.f);
+    vec2_t grazing  = ibl_brdf(ibl, 0.05f, 0.5f);
+
+    // smooth surface seen head on reflects F0 only
+    ASSERT_TRUE(f_abs(smooth.x - 1.f) < 0.05f);
+    ASSERT_TRUE(smooth.y < 0.05f);
+
+    // fresnel term grows at grazing angles
+    ASSERT_TRUE(grazing.y > smooth.y);
+    ASSERT_TRUE(grazing.x + grazing.y <= 1.01f);
+
+    // filtered, halfway between two texel centres is their average
+    const float* lut    = &ibl->brdf_lut[(10 * IBL_LUT_SIZE + 4) * 2];
+    vec2_t halfway      = ibl_brdf(ibl, 5.f / IBL_LUT_SIZE, 10.5f / IBL_LUT_SIZE);
+    ASSERT_TRUE(f_abs(halfway.x - (lut[0] + lut[2]) * 0.5f) < 0.0001f);
+    ASSERT_TRUE(f_abs(halfway.y - (lut[1] + lut[3]) * 0.5f) < 0.0001f);
+
+    ibl_free(ibl);
+}
+
+void test_ibl()
+{
+    TEST_CASE(test_constant_irradiance);
+    TEST_CASE(test_constant_specular);
+    TEST_CASE(test_brdf_lut);
+}
@@ -0,0 +1,74 @@
+#include "test_input_script.h"
+
+#include "test_utils.h"
+#include "../input_script.h"
+
+static void test_events()
+{
+    input_script_t* script = input_script_new("./assets/scripts/orbit.txt", 0);
+    ASSERT_EQUAL(script->size, 8u);
+
+    // events of a frame are merged, the drags add up
+    input_t input = input_script_next(script);
+    ASSERT_TRUE(input.keys == LEFT_CLICK);
+    ASSERT_TRUE(input.curr_x - input.prev_x == 40);
+    ASSERT_TRUE(input.curr_y - input.prev_y == -5);
+
+    // frames without events are empty
+    for (uint32_t frame = 1; frame < 10; frame++)
+    {
+        input = input_script_next(script);
+        ASSERT_TRUE(input.keys == 0);
+    }
+
+    ASSERT_TRUE(input_script_next(script).keys == KEY_3);
+
+    for (uint32_t frame = 11; frame < 30; frame++)
+    {
+        input = input_script_next(script);
+    }
+
+    input = input_script_next(script);
+    ASSERT_EQUAL(input.width, 1280u);
+    ASSERT_EQUAL(input.height, 720u);
+
+    for (uint32_t frame = 31; frame < 60; frame++)
+    {
+        input = input_script_next(script);
+        ASSERT_TRUE((input.keys & QUIT) == 0);
+    }
+
+    ASSERT_TRUE((input_script_next(script).keys & QUIT) != 0);
+
+    input_script_free(script);
+}
+
+static void test_frame_limit()
+{
+    // without a script the run quits on its last frame
+    input_script_t* script = input_script_new(NULL, 3);
+
+    ASSERT_TRUE(input_script_next(script).keys == 0);
+    ASSERT_TRUE(input_script_next(script).keys == 0);
+    ASSERT_TRUE(input_script_next(script).keys == QUIT);
+
+    input_script_free(script);
+
+    // the limit also cuts a script short
+    script = input_script_new("./assets/scripts/orbit.txt", 5);
+
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        ASSERT_TRUE((input_script_next(script).keys & QUIT) == 0);
+    }
+
+    ASSERT_TRUE((input_script_next(script).keys & QUIT) != 0);
+
+    input_script_free(script);
+}
+
+void test_input_script()
+{
+    TEST_CASE(test_events);
+    TEST_CASE(test_frame_limit);
+}
@@ -0,0 +1,104 @@
+#include "test_light.h"
+
+#include "test_utils.h"
+#include "../light.h"
+
+static camera_t* create_camera()
+{
+    return camera_new(vec4_new(0.f, 0.f, 0.f),
+                      F_PI / 2.f,
+                      0.f,
+                      0.5f,
+                      45 * F_PI / 180.f,
+                      0.1f,
+                      20.f,
+                      1.3333f);
+}
+
+static void test_directional_light_in_all_tiles()
+{
+    camera_t* cam       = create_camera();
+    light_grid_t* grid  = light_grid_new(800, 600);
+    light_t light       = light_new_directional(vec4_new(0.f, -1.f, 0.f), vec4_from_scalar(1.f), 1.f);
+
+    light_grid_build(grid, &light, 1, cam);
+
+    ASSERT_EQUAL(grid->tiles_x, 25);
+    ASSERT_EQUAL(grid->tiles_y, 19);
+
+    for (uint32_t i = 0; i < grid->tiles_x * grid->tiles_y; i++)
+    {
+        ASSERT_EQUAL(grid->tiles[i].size, 1);
+    }
+
+    light_grid_free(grid);
+    camera_free(cam);
+}
+
+static void test_point_light_in_center_tiles()
+{
+    camera_t* cam       = create_camera();
+    light_grid_t* grid  = light_grid_new(800, 600);
+    light_t light       = light_new_point(vec4_new(0.f, 0.f, 0.f), vec4_from_scalar(1.f), 1.f, 0.01f);
+
+    light_grid_build(grid, &light, 1, cam);
+
+    const light_tile_t* center  = light_grid_get(grid, 400, 300);
+    const light_tile_t* corner  = light_grid_get(grid, 0, 0);
+    const light_tile_t* edge    = light_grid_get(grid, 799, 300);
+
+    ASSERT_EQUAL(center->size, 1);
+    ASSERT_EQUAL((uint32_t)center->indices[0], 0);
+    ASSERT_EQUAL(corner->size, 0);
+    ASSERT_EQUAL(edge->size, 0);
+
+    light_grid_free(grid);
+    camera_free(cam);
+}
+
+static void test_point_light_behind_camera()
+{
+    camera_t* cam       = create_camera();
+    light_grid_t* grid  = light_grid_new(800, 600);
+    vec4_t behind       = vec4_add(cam->position_w, vec4_scale(cam->forward, 1.f));
+    light_t light       = light_new_point(behind, vec4_from_scalar(1.f), 1.f, 0.2f);
+
+    light_grid_build(grid, &light, 1, cam);
+
+    for (uint32_t i = 0; i < grid->tiles_x * grid->tiles_y; i++)
+    {
+        ASSERT_EQUAL(grid->tiles[i].size, 0);
+    }
+
+    light_grid_free(grid);
+    camera_free(cam);
+}
+
+static void test_tile_capacity()
+{
+    camera_t* cam       = create_camera();
+    light_grid_t* grid  = light_grid_new(800, 600);
+    light_t lights[MAX_LIGHTS];
+
+    for (uint32_t i = 0; i < MAX_LIGHTS; i++)
+    {
+        lights[i] = light_new_point(vec4_new(0.f, 0.f, 0.f), vec4_from_scalar(1.f), 1.f, 0.01f);
+    }
+
+    light_grid_build(grid, lights, MAX_LIGHTS, cam);
+
+    // no light is dropped when they all overlap the same tile
+    const light_tile_t* center = light_grid_get(grid, 400, 300);
+    ASSERT_EQUAL(center->size, MAX_LIGHTS);
+
+    light_grid_free(grid);
+    camera_free(cam);
+}
+
+void test_light()
+{
+    TEST_CASE(test_directional_light_in_all_tiles);
+    TEST_CASE(test_point_light_in_center_tiles);
+    TEST_CASE(test_point_light_behind_camera);
+    TEST_CASE(test_tile_capacity);
+}
@@ -9,6 +9,20 @@
 #include "test_time_utils.h"
 #include "test_file.h"
 #include "test_math_utils.h"
+#include "test_light.h"
+#include "test_ibl.h"
+#include "test_shadow.h"
+#include "test_ssao.h"
+#include "test_vrs.h"
+#include "test_texture.h"
+#include "test_bc.h"
+#include "test_framebuffer.h"
+#include "test_texture_manager.h"
+#include "test_texture_stream.h"
+#include "test_texture_atlas.h"
+#include "test_frame_queue.h"
+#include "test_resolution_scaler.h"
+#include "test_input_script.h"
 
 #include "test_utils.h"
 
@@ -23,6 +37,20 @@ int32_t main()
     TEST_GROUP(test_json);
     TEST_GROUP(test_png);
     TEST_GROUP(test_crc);
+    TEST_GROUP(test_light);
+    TEST_GROUP(test_ibl);
+    TEST_GROUP(test_shadow);
+    TEST_GROUP(test_ssao);
+    TEST_GROUP(test_vrs);
+    TEST_GROUP(test_texture);
+    TEST_GROUP(test_bc);
+    TEST_GROUP(test_texture_manager);
+    TEST_GROUP(test_texture_stream);
+    TEST_GROUP(test_texture_atlas);
+    TEST_GROUP(test_framebuffer);
+    TEST_GROUP(test_frame_queue);
+    TEST_GROUP(test_resolution_scaler);
+    TEST_GROUP(test_input_script);
     TEST_GROUP(test_scene);
     TEST_GROUP(test_time_utils);
     TEST_GROUP(test_file);
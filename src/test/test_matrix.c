@@ -212,6 +212,23 @@ static void test_mat_translate()
 }
 
 
+
+static void test_quat_rotate()
+{
+    // 90 degrees around y
+    quat_t q        = quat_new(0.f, 0.7071068f, 0.f, 0.7071068f);
+    vec4_t actual   = quat_rotate(q, vec4_new(0.f, 0.f, -1.f));
+    vec4_t expected = vec4_new(-1.f, 0.f, 0.f);
+
+    ASSERT_VECTOR4(actual, expected);
+
+    actual          = quat_rotate(quat_identity(), vec4_new(1.f, 2.f, 3.f));
+    expected        = vec4_new(1.f, 2.f, 3.f);
+
+    ASSERT_VECTOR4(actual, expected);
+}
+
+
 void test_matrix()
 {
     TEST_CASE(test_matrix_add);
@@ -229,4 +246,5 @@ void test_matrix()
     TEST_CASE(test_rad_to_deg);
     TEST_CASE(test_mat_from_vec4);
     TEST_CASE(test_mat_translate);
+    TEST_CASE(test_quat_rotate);
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "test_resolution_scaler.h"
+
+#include "test_utils.h"
+#include "../resolution_scaler.h"
+
+#define BUDGET (16 * MILLISECOND)
+
+static float run_frames(resolution_scaler_t* scaler, float scale, timestamp_t render_time, uint32_t frames)
+{
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        scale = resolution_scaler_update(scaler, scale, render_time);
+    }
+
+    return scale;
+}
+
+static void test_history()
+{
+    resolution_scaler_t* scaler = resolution_scaler_new(BUDGET, 0.25f, 1.f);
+
+    // nothing changes until a full history was measured
+    ASSERT_EQUAL(run_frames(scaler, 1.f, 4 * BUDGET, RESOLUTION_HISTORY - 1), 1.f);
+    ASSERT_TRUE(resolution_scaler_update(scaler, 1.f, 4 * BUDGET) < 1.f);
+
+    // and again after every change
+    ASSERT_EQUAL(scaler->count, 0);
+    ASSERT_EQUAL(run_frames(scaler, 0.5f, 4 * BUDGET, RESOLUTION_HISTORY - 1), 0.5f);
+
+    resolution_scaler_free(scaler);
+}
+
+static void test_over_budget()
+{
+    resolution_scaler_t* scaler = resolution_scaler_new(BUDGET, 0.25f, 1.f);
+
+    // 4x the budget needs a quarter of the pixels, half the scale, less the headroom
+    ASSERT_EQUAL(run_frames(scaler, 1.f, 4 * BUDGET, RESOLUTION_HISTORY), 0.4375f);
+
+    // slightly over still drops a step
+    ASSERT_EQUAL(run_frames(scaler, 0.5f, BUDGET + MILLISECOND, RESOLUTION_HISTORY), 0.4375f);
+
+    // never below the bound
+    ASSERT_EQUAL(run_frames(scaler, 0.5f, 100 * BUDGET, RESOLUTION_HISTORY), 0.25f);
+
+    resolution_scaler_free(scaler);
+}
+
+static void test_under_budget()
+{
+    resolution_scaler_t* scaler = resolution_scaler_new(BUDGET, 0.25f, 0.75f);
+
+    // far below the budget it rises one step at a time
+    ASSERT_EQUAL(run_frames(scaler, 0.5f, BUDGET / 10, RESOLUTION_HISTORY), 0.5625f);
+
+    // close to the budget it holds
+    ASSERT_EQUAL(run_frames(scaler, 0.5f, BUDGET * 4 / 5, 4 * RESOLUTION_HISTORY), 0.5f);
+
+    // never above the bound, scales outside the bounds are pulled in right away
+    ASSERT_EQUAL(run_frames(scaler, 0.75f, BUDGET / 10, RESOLUTION_HISTORY), 0.75f);
+    ASSERT_EQUAL(resolution_scaler_update(scaler, 1.f, BUDGET / 10), 0.75f);
+
+    resolution_scaler_free(scaler);
+}
+
+void test_resolution_scaler()
+{
+    TEST_CASE(test_history);
+    TEST_CASE(test_over_budget);
+    TEST_CASE(test_under_budget);
+}
@@ -20,19 +20,23 @@ static void test_water_bottle()
 
     ASSERT_EQUAL(scene->mesh->albedo->width, 2048);
     ASSERT_EQUAL(scene->mesh->albedo->height, 2048);
-    ASSERT_EQUAL(scene->mesh->albedo->stride, 3);
+    ASSERT_EQUAL(scene->mesh->albedo->stride, 6);
+    ASSERT_EQUAL(scene->mesh->albedo->format, TEXTURE_FORMAT_RGB16_LINEAR);
 
     ASSERT_EQUAL(scene->mesh->metallic->width, 2048);
     ASSERT_EQUAL(scene->mesh->metallic->height, 2048);
-    ASSERT_EQUAL(scene->mesh->metallic->stride, 3);
+    ASSERT_EQUAL(scene->mesh->metallic->stride, 2);
+    ASSERT_EQUAL(scene->mesh->metallic->format, TEXTURE_FORMAT_RG8);
 
     ASSERT_EQUAL(scene->mesh->normal->width, 2048);
     ASSERT_EQUAL(scene->mesh->normal->height, 2048);
     ASSERT_EQUAL(scene->mesh->normal->stride, 3);
+    ASSERT_EQUAL(scene->mesh->normal->format, TEXTURE_FORMAT_XYZ8_SNORM);
 
     ASSERT_EQUAL(scene->mesh->occlusion->width, 2048);
     ASSERT_EQUAL(scene->mesh->occlusion->height, 2048);
-    ASSERT_EQUAL(scene->mesh->occlusion->stride, 3);
+    ASSERT_EQUAL(scene->mesh->occlusion->stride, 1);
+    ASSERT_EQUAL(scene->mesh->occlusion->format, TEXTURE_FORMAT_R8);
 
     scene_free(scene);
 }
@@ -0,0 +1,113 @@
+#include "test_shadow.h"
+
+#include "test_utils.h"
+#include "../shadow.h"
+
+// ground quad at y = 0 with a smaller occluder quad floating above its center
+static vec4_t vertices[8];
+static uint32_t indices[12] = { 0, 2, 1, 0, 3, 2,
+                                4, 6, 5, 4, 7, 6 };
+
+static mesh_t create_mesh()
+{
+    float sizes[2]      = { 1.f, 0.2f };
+    float heights[2]    = { 0.f, 0.5f };
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        float s         = sizes[i];
+        float h         = heights[i];
+        vertices[i * 4 + 0] = vec4_new(-s, h, -s);
+        vertices[i * 4 + 1] = vec4_new( s, h, -s);
+        vertices[i * 4 + 2] = vec4_new( s, h,  s);
+        vertices[i * 4 + 3] = vec4_new(-s, h,  s);
+    }
+
+    mesh_t mesh             = { 0 };
+    mesh.vertices           = vertices;
+    mesh.indices            = indices;
+    mesh.vertices_size      = 8;
+    mesh.indices_size       = 12;
+    mesh.bounding_sphere.c  = vec4_new(0.f, 0.25f, 0.f);
+    mesh.bounding_sphere.r  = 1.5f;
+
+    return mesh;
+}
+
+static camera_t* create_camera()
+{
+    return camera_new(vec4_new(0.f, 0.f, 0.f),
+                      0.3f,
+                      0.f,
+                      3.f,
+                      45 * F_PI / 180.f,
+                      0.1f,
+                      20.f,
+                      1.3333f);
+}
+
+static void test_occluder_casts_shadow()
+{
+    mesh_t mesh                 = create_mesh();
+    camera_t* cam               = create_camera();
+    shadow_map_t* shadow_map    = shadow_map_new(256);
+    light_t light               = light_new_directional(vec4_new(0.f, -1.f, 0.f), vec4_from_scalar(1.f), 1.f);
+    vec4_t up                   = vec4_new(0.f, 1.f, 0.f);
+
+    shadow_map_render_begin(shadow_map, &light, 1, cam, &mesh);
+    shadow_map_render_end(shadow_map);
+
+    ASSERT_EQUAL(shadow_map->light, 0);
+    ASSERT_EQUAL(shadow_map_visibility(shadow_map, vec4_new(0.f, 0.f, 0.f), up), 0.f);
+    ASSERT_EQUAL(shadow_map_visibility(shadow_map, vec4_new(0.7f, 0.f, 0.7f), up), 1.f);
+    ASSERT_EQUAL(shadow_map_visibility(shadow_map, vec4_new(-0.6f, 0.f, 0.f), up), 1.f);
+
+    // the occluder itself is not shadowed by its own depth
+    ASSERT_EQUAL(shadow_map_visibility(shadow_map, vec4_new(0.f, 0.5f, 0.f), up), 1.f);
+
+    shadow_map_free(shadow_map);
+    camera_free(cam);
+}
+
+static void test_no_directional_light()
+{
+    mesh_t mesh                 = create_mesh();
+    camera_t* cam               = create_camera();
+    shadow_map_t* shadow_map    = shadow_map_new(64);
+    light_t light               = light_new_point(vec4_new(0.f, 1.f, 0.f), vec4_from_scalar(1.f), 1.f, 0.f);
+
+    shadow_map_render_begin(shadow_map, &light, 1, cam, &mesh);
+    shadow_map_render_end(shadow_map);
+
+    ASSERT_EQUAL(shadow_map->light, MAX_LIGHTS);
+
+    shadow_map_free(shadow_map);
+    camera_free(cam);
+}
+
+static void test_cascade_splits()
+{
+    mesh_t mesh                 = create_mesh();
+    camera_t* cam               = create_camera();
+    shadow_map_t* shadow_map    = shadow_map_new(64);
+    light_t light               = light_new_directional(vec4_new(0.f, -1.f, 0.f), vec4_from_scalar(1.f), 1.f);
+
+    shadow_map_render_begin(shadow_map, &light, 1, cam, &mesh);
+    shadow_map_render_end(shadow_map);
+
+    for (uint32_t i = 1; i < SHADOW_CASCADES; i++)
+    {
+        ASSERT_TRUE(shadow_map->cascades[i].split_far > shadow_map->cascades[i - 1].split_far);
+        ASSERT_TRUE(shadow_map->cascades[i].texel_size >= shadow_map->cascades[i - 1].texel_size);
+    }
+
+    shadow_map_free(shadow_map);
+    camera_free(cam);
+}
+
+void test_shadow()
+{
+    TEST_CASE(test_occluder_casts_shadow);
+    TEST_CASE(test_no_directional_light);
+    TEST_CASE(test_cascade_splits);
+}
@@ -0,0 +1,103 @@
+#include "test_ssao.h"
+
+#include "test_utils.h"
+#include "../ssao.h"
+
+static camera_t* create_camera()
+{
+    return camera_new(vec4_new(0.f, 0.f, 0.f),
+                      F_PI / 2.f,
+                      0.f,
+                      1.f,
+                      45 * F_PI / 180.f,
+                      0.1f,
+                      20.f,
+                      1.f);
+}
+
+static void fill(depthbuffer_t* depth, float left_depth, float right_depth)
+{
+    for (uint32_t y = 0; y < depth->height; y++)
+    {
+        for (uint32_t x = 0; x < depth->width; x++)
+        {
+            depthbuffer_set(depth, x, y, x < depth->width / 2 ? left_depth : right_depth);
+        }
+    }
+}
+
+static void test_flat_surface_not_occluded()
+{
+    camera_t* cam           = create_camera();
+    depthbuffer_t* depth    = depthbuffer_new(64, 64);
+    ssao_t* ssao            = ssao_new(64, 64);
+
+    fill(depth, 0.1f, 0.1f);
+    ssao_compute(ssao, depth, cam, 0.1f);
+
+    ASSERT_EQUAL(ssao->width, 32);
+    ASSERT_EQUAL(ssao->height, 32);
+    ASSERT_EQUAL(ssao_occlusion(ssao, 32, 32), 1.f);
+    ASSERT_EQUAL(ssao_occlusion(ssao, 5, 60), 1.f);
+
+    ssao_free(ssao);
+    depthbuffer_free(depth);
+    camera_free(cam);
+}
+
+static void test_step_is_occluded()
+{
+    camera_t* cam           = create_camera();
+    depthbuffer_t* depth    = depthbuffer_new(64, 64);
+    ssao_t* ssao            = ssao_new(64, 64);
+
+    // the left half is a wall in front of the right half
+    fill(depth, 0.1f, 0.09f);
+    ssao_compute(ssao, depth, cam, 0.1f);
+
+    float near_step         = ssao_occlusion(ssao, 34, 32);
+    float far_away          = ssao_occlusion(ssao, 63, 32);
+    float wall              = ssao_occlusion(ssao, 16, 32);
+
+    ASSERT_TRUE(near_step < 1.f);
+    ASSERT_TRUE(near_step < far_away);
+    ASSERT_EQUAL(wall, 1.f);
+
+    // the workers stay alive between frames
+    ssao_compute(ssao, depth, cam, 0.1f);
+
+    ASSERT_EQUAL(ssao_occlusion(ssao, 34, 32), near_step);
+
+    ssao_free(ssao);
+    depthbuffer_free(depth);
+    camera_free(cam);
+}
+
+static void test_background_untouched()
+{
+    camera_t* cam           = create_camera();
+    depthbuffer_t* depth    = depthbuffer_new(64, 64);
+    ssao_t* ssao            = ssao_new(64, 64);
+
+    fill(depth, 0.f, 0.f);
+    ssao_compute(ssao, depth, cam, 0.1f);
+
+    for (uint32_t y = 0; y < 64; y++)
+    {
+        for (uint32_t x = 0; x < 64; x++)
+        {
+            ASSERT_EQUAL(ssao_occlusion(ssao, x, y), 1.f);
+        }
+    }
+
+    ssao_free(ssao);
+    depthbuffer_free(depth);
+    camera_free(cam);
+}
+
+void test_ssao()
+{
+    TEST_CASE(test_flat_surface_not_occluded);
+    TEST_CASE(test_step_is_occluded);
+    TEST_CASE(test_background_untouched);
+}
@@ -0,0 +1,414 @@
+#include "test_texture.h"
+
+#include <math.h>
+
+#include "test_utils.h"
+#include "../texture.h"
+#include "../settings.h"
+
+// 8x4 rgb checker of 0 and 200 with single texel squares
+static texture_t* create_checker()
+{
+    texture_t* texture = texture_new(8, 4, 3, TEXTURE_LAYOUT_LINEAR);
+
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        for (uint32_t x = 0; x < 8; x++)
+        {
+            unsigned char value = (x + y) % 2 ? 200 : 0;
+            texture->data[(y * 8 + x) * 3 + 0] = value;
+            texture->data[(y * 8 + x) * 3 + 1] = value;
+            texture->data[(y * 8 + x) * 3 + 2] = value;
+        }
+    }
+
+    return texture;
+}
+
+static void test_mip_chain()
+{
+    texture_t* texture = create_checker();
+
+    ASSERT_EQUAL(texture->levels, 1);
+
+    texture_generate_mips(texture);
+
+    ASSERT_EQUAL(texture->levels, 4);
+    ASSERT_EQUAL(texture->mips[1].width, 4);
+    ASSERT_EQUAL(texture->mips[1].height, 2);
+    ASSERT_EQUAL(texture->mips[2].width, 2);
+    ASSERT_EQUAL(texture->mips[2].height, 1);
+    ASSERT_EQUAL(texture->mips[3].width, 1);
+    ASSERT_EQUAL(texture->mips[3].height, 1);
+    ASSERT_POINTER(texture->mips[0].data, texture->data);
+
+    // every 2x2 block of the checker averages to 100
+    for (uint32_t i = 1; i < texture->levels; i++)
+    {
+        ASSERT_EQUAL((uint32_t)texture->mips[i].data[0], 100);
+    }
+
+    texture_free(texture);
+}
+
+static void test_lod()
+{
+    texture_t* texture = create_checker();
+    texture_generate_mips(texture);
+
+    // one texel per pixel
+    ASSERT_EQUAL(texture_lod(texture, vec2_new(1.f / 8.f, 0.f), vec2_new(0.f, 1.f / 4.f)), 0.f);
+
+    // magnification clamps to the base level
+    ASSERT_EQUAL(texture_lod(texture, vec2_new(0.01f, 0.f), vec2_new(0.f, 0.01f)), 0.f);
+
+    // 4 texels per pixel along the major axis
+    ASSERT_EQUAL(texture_lod(texture, vec2_new(0.5f, 0.f), vec2_new(0.f, 0.1f)), 2.f);
+
+    // never past the last level
+    ASSERT_EQUAL(texture_lod(texture, vec2_new(100.f, 0.f), vec2_new(0.f, 100.f)), 3.f);
+
+    texture_free(texture);
+}
+
+static void test_trilinear_minification()
+{
+    texture_t* texture = create_checker();
+    texture_generate_mips(texture);
+
+    while (get_texture_filter() != TRILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // the whole texture in one pixel reads the average instead of a single texel
+    vec4_t far  = texture_sample(texture, 0.3f, 0.6f, vec2_new(1.f, 0.f), vec2_new(0.f, 1.f));
+    vec4_t near = texture_sample(texture, 1.f / 16.f, 1.f / 8.f, vec2_new(0.001f, 0.f), vec2_new(0.f, 0.001f));
+
+    ASSERT_EQUAL(far.x, 100.f / 255.f);
+    ASSERT_EQUAL(far.z, 100.f / 255.f);
+    ASSERT_EQUAL(near.x, 0.f);
+
+    texture_free(texture);
+}
+
+static void test_tiled_layout()
+{
+    texture_t* linear   = create_checker();
+    texture_t* tiled    = create_checker();
+
+    // odd sizes leave partial tiles
+    texture_generate_mips(linear);
+    texture_generate_mips(tiled);
+    texture_set_layout(tiled, TEXTURE_LAYOUT_TILED);
+
+    ASSERT_EQUAL(tiled->layout, TEXTURE_LAYOUT_TILED);
+    ASSERT_POINTER(tiled->mips[0].data, tiled->data);
+
+    // second tile of the first tile row starts after 16 texels
+    ASSERT_EQUAL(texture_texel_index(tiled, &tiled->mips[0], 4, 0), 16);
+    ASSERT_EQUAL(texture_texel_index(tiled, &tiled->mips[0], 1, 1), 5);
+    ASSERT_EQUAL(texture_texel_index(linear, &linear->mips[0], 1, 1), 9);
+
+    for (uint32_t i = 0; i < linear->levels; i++)
+    {
+        const texture_level_t* l = &linear->mips[i];
+        const texture_level_t* t = &tiled->mips[i];
+
+        for (uint32_t y = 0; y < l->height; y++)
+        {
+            for (uint32_t x = 0; x < l->width; x++)
+            {
+                uint32_t a = texture_texel_index(linear, l, x, y) * 3;
+                uint32_t b = texture_texel_index(tiled, t, x, y) * 3;
+                ASSERT_EQUAL((uint32_t)l->data[a], (uint32_t)t->data[b]);
+            }
+        }
+    }
+
+    texture_free(linear);
+    texture_free(tiled);
+}
+
+static vec4_t sample_first_texel(texture_format_e format, uint32_t stride)
+{
+    texture_t* texture  = create_checker();
+    texture->data[0]    = 255;
+    texture->data[1]    = 128;
+    texture->data[2]    = 0;
+
+    texture_set_format(texture, format);
+    texture_generate_mips(texture);
+
+    ASSERT_EQUAL(texture->format, format);
+    ASSERT_EQUAL(texture->stride, stride);
+    ASSERT_POINTER(texture->mips[0].data, texture->data);
+
+    // center of texel (0, 0) at the base level
+    vec4_t result       = texture_sample(texture, 1.f / 16.f, 1.f / 8.f, vec2_new(0.001f, 0.f), vec2_new(0.f, 0.001f));
+
+    texture_free(texture);
+
+    return result;
+}
+
+static void test_formats()
+{
+    while (get_texture_filter() != TRILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // rgb (255, 128, 0) comes back as b g r
+    vec4_t albedo       = sample_first_texel(TEXTURE_FORMAT_RGB16_LINEAR, 6);
+    ASSERT_EQUAL(albedo.x, 0.f);
+    ASSERT_EQUAL(albedo.y, powf(128.f / 255.f, 2.2f));
+    ASSERT_EQUAL(albedo.z, 1.f);
+
+    vec4_t metallic     = sample_first_texel(TEXTURE_FORMAT_RG8, 2);
+    ASSERT_EQUAL(metallic.x, 0.f);
+    ASSERT_EQUAL(metallic.y, 128.f / 255.f);
+
+    vec4_t occlusion    = sample_first_texel(TEXTURE_FORMAT_R8, 1);
+    ASSERT_EQUAL(occlusion.z, 1.f);
+
+    // normals are x y z in [-1, 1]
+    vec4_t normal       = sample_first_texel(TEXTURE_FORMAT_XYZ8_SNORM, 3);
+    ASSERT_EQUAL(normal.x, 1.f);
+    ASSERT_EQUAL(normal.y, 0.f);
+    ASSERT_EQUAL(normal.z, -1.f);
+
+    // mips of linear albedo average the linear values
+    texture_t* texture  = create_checker();
+    texture_set_format(texture, TEXTURE_FORMAT_RGB16_LINEAR);
+    texture_generate_mips(texture);
+
+    vec4_t far          = texture_sample(texture, 0.3f, 0.6f, vec2_new(1.f, 0.f), vec2_new(0.f, 1.f));
+    ASSERT_TRUE(f_abs(far.x - powf(200.f / 255.f, 2.2f) * 0.5f) < 0.001f);
+
+    texture_free(texture);
+}
+
+static void test_bilinear_blend()
+{
+    while (get_texture_filter() != BILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // row 0 of the checker goes 0, 200, the sample points sit on the texel center row
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        texture_t* texture  = create_checker();
+        float scale         = 1.f;
+
+        if (i == 1)
+        {
+            texture_set_format(texture, TEXTURE_FORMAT_RGB16_LINEAR);
+            scale           = powf(200.f / 255.f, 2.2f) / (200.f / 255.f);
+        }
+
+        vec4_t half         = texture_sample(texture, 1.f / 8.f, 1.f / 8.f, vec2_new(0.f, 0.f), vec2_new(0.f, 0.f));
+        vec4_t quarter      = texture_sample(texture, 0.75f / 8.f, 1.f / 8.f, vec2_new(0.f, 0.f), vec2_new(0.f, 0.f));
+
+        ASSERT_TRUE(f_abs(half.x - 100.f / 255.f * scale) < 1.f / 255.f);
+        ASSERT_TRUE(f_abs(half.z - 100.f / 255.f * scale) < 1.f / 255.f);
+        ASSERT_TRUE(f_abs(quarter.y - 50.f / 255.f * scale) < 1.f / 255.f);
+
+        texture_free(texture);
+    }
+}
+
+// single row gradient, texel x holds 10 * x in every channel
+static texture_t* create_row(uint32_t width)
+{
+    texture_t* texture = texture_new(width, 1, 3, TEXTURE_LAYOUT_LINEAR);
+
+    for (uint32_t x = 0; x < width * 3; x++)
+    {
+        texture->data[x] = (unsigned char)(10 * (x / 3));
+    }
+
+    return texture;
+}
+
+static uint32_t sample_row(texture_t* texture, float u)
+{
+    return (uint32_t)f_round(texture_sample(texture, u, 0.5f, vec2_new(0.f, 0.f), vec2_new(0.f, 0.f)).x * 25.5f);
+}
+
+static void test_wrap_modes()
+{
+    while (get_texture_filter() != POINT_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // power of two: u = -0.1 is texel -1, u = 1.3 is texel 5
+    texture_t* pot  = create_row(4);
+    ASSERT_TRUE(pot->pot);
+
+    ASSERT_EQUAL(sample_row(pot, -0.1f), 3);
+    ASSERT_EQUAL(sample_row(pot, 1.3f), 1);
+
+    texture_set_wrap(pot, TEXTURE_WRAP_CLAMP, TEXTURE_WRAP_CLAMP);
+    ASSERT_EQUAL(sample_row(pot, -0.1f), 0);
+    ASSERT_EQUAL(sample_row(pot, 1.3f), 3);
+
+    texture_set_wrap(pot, TEXTURE_WRAP_MIRROR, TEXTURE_WRAP_MIRROR);
+    ASSERT_EQUAL(sample_row(pot, -0.1f), 0);
+    ASSERT_EQUAL(sample_row(pot, 1.3f), 2);
+
+    // npot: u = -0.1 is texel -1, u = 1.3 is texel 3
+    texture_t* npot = create_row(3);
+    ASSERT_TRUE(!npot->pot);
+
+    ASSERT_EQUAL(sample_row(npot, -0.1f), 2);
+    ASSERT_EQUAL(sample_row(npot, 1.3f), 0);
+
+    texture_set_wrap(npot, TEXTURE_WRAP_CLAMP, TEXTURE_WRAP_CLAMP);
+    ASSERT_EQUAL(sample_row(npot, -0.1f), 0);
+    ASSERT_EQUAL(sample_row(npot, 1.3f), 2);
+
+    texture_set_wrap(npot, TEXTURE_WRAP_MIRROR, TEXTURE_WRAP_MIRROR);
+    ASSERT_EQUAL(sample_row(npot, -0.1f), 0);
+    ASSERT_EQUAL(sample_row(npot, 1.3f), 2);
+
+    // bilinear across the seam blends the last and the first texel
+    while (get_texture_filter() != BILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    texture_set_wrap(pot, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_REPEAT);
+    ASSERT_TRUE(f_abs(texture_sample(pot, 0.f, 0.5f, vec2_new(0.f, 0.f), vec2_new(0.f, 0.f)).x - 15.f / 255.f) < 1.f / 255.f);
+
+    texture_free(pot);
+    texture_free(npot);
+}
+
+static void test_anisotropic()
+{
+    // 8x8 with rows alternating 0 and 200, the footprint is 8 texels along u and one along v
+    texture_t* texture  = texture_new(8, 8, 3, TEXTURE_LAYOUT_LINEAR);
+
+    for (uint32_t i = 0; i < 8 * 8 * 3; i++)
+    {
+        texture->data[i] = (i / 24) % 2 ? 200 : 0;
+    }
+
+    texture_generate_mips(texture);
+
+    vec2_t dx           = vec2_new(1.f, 0.f);
+    vec2_t dy           = vec2_new(0.f, 1.f / 8.f);
+
+    while (get_texture_filter() != TRILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // the isotropic level for the long axis blurs the rows together
+    vec4_t trilinear    = texture_sample(texture, 0.5f, 1.f / 16.f, dx, dy);
+    ASSERT_TRUE(f_abs(trilinear.x - 100.f / 255.f) < 1.f / 255.f);
+
+    change_texture_filter();
+    ASSERT_EQUAL(get_texture_filter(), ANISOTROPIC_SAMPLE);
+
+    // probes along u stay on row 0 at the base level
+    set_max_anisotropy(8);
+    vec4_t aniso        = texture_sample(texture, 0.5f, 1.f / 16.f, dx, dy);
+    ASSERT_TRUE(aniso.x < 1.f / 255.f);
+
+    // fewer probes than the anisotropy fall back to coarser levels
+    set_max_anisotropy(2);
+    vec4_t limited      = texture_sample(texture, 0.5f, 1.f / 16.f, dx, dy);
+    ASSERT_TRUE(limited.x > aniso.x);
+
+    // isotropic footprints match trilinear
+    vec4_t iso          = texture_sample(texture, 0.3f, 0.3f, vec2_new(0.5f, 0.f), vec2_new(0.f, 0.5f));
+    set_max_anisotropy(1);
+    ASSERT_EQUAL(get_max_anisotropy(), MIN_ANISOTROPY);
+    set_max_anisotropy(64);
+    ASSERT_EQUAL(get_max_anisotropy(), MAX_ANISOTROPY);
+    set_max_anisotropy(8);
+
+    change_texture_filter();
+    change_texture_filter();
+    change_texture_filter();
+    ASSERT_EQUAL(get_texture_filter(), TRILINEAR_SAMPLE);
+    vec4_t tri          = texture_sample(texture, 0.3f, 0.3f, vec2_new(0.5f, 0.f), vec2_new(0.f, 0.5f));
+    ASSERT_EQUAL(iso.x, tri.x);
+
+    texture_free(texture);
+}
+
+static void test_compressed()
+{
+    while (get_texture_filter() != BILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // 16x16 diagonal gradient compressed against the uncompressed original, in each role. BC1 fits one line
+    // through the colors of a block so the channels change together
+    texture_format_e formats[]  = { TEXTURE_FORMAT_RGB8, TEXTURE_FORMAT_RGB16_LINEAR, TEXTURE_FORMAT_RG8, TEXTURE_FORMAT_R8 };
+    float ratios[]              = { 5.5f, 11.f, 1.8f, 1.8f };   // the 1x1 and 2x2 levels still take a whole block
+
+    for (uint32_t f = 0; f < 4; f++)
+    {
+        texture_t* reference    = texture_new(16, 16, 3, TEXTURE_LAYOUT_LINEAR);
+        texture_t* texture      = texture_new(16, 16, 3, TEXTURE_LAYOUT_LINEAR);
+
+        for (uint32_t i = 0; i < 16 * 16; i++)
+        {
+            uint32_t t          = (i % 16 + i / 16) * 8;
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                unsigned char value = (unsigned char)(c == 0 ? t : (c == 1 ? 255 - t : t / 2));
+                reference->data[i * 3 + c] = value;
+                texture->data[i * 3 + c]   = value;
+            }
+        }
+
+        texture_set_format(reference, formats[f]);
+        texture_set_format(texture, formats[f]);
+        texture_generate_mips(reference);
+        texture_generate_mips(texture);
+
+        uint32_t size           = texture_memory_size(texture);
+        texture_compress(texture);
+
+        ASSERT_TRUE(texture->compressed);
+        ASSERT_TRUE((float)size / (float)texture_memory_size(texture) >= ratios[f]);
+
+        for (float v = 0.05f; v < 1.f; v += 0.1f)
+        {
+            for (float u = 0.05f; u < 1.f; u += 0.1f)
+            {
+                vec4_t a        = texture_sample(reference, u, v, vec2_new(0.f, 0.f), vec2_new(0.f, 0.f));
+                vec4_t b        = texture_sample(texture, u, v, vec2_new(0.f, 0.f), vec2_new(0.f, 0.f));
+
+                ASSERT_TRUE(f_abs(a.x - b.x) < 0.05f);
+                ASSERT_TRUE(f_abs(a.y - b.y) < 0.05f);
+                ASSERT_TRUE(f_abs(a.z - b.z) < 0.05f);
+            }
+        }
+
+        texture_free(reference);
+        texture_free(texture);
+    }
+}
+
+void test_texture()
+{
+    TEST_CASE(test_mip_chain);
+    TEST_CASE(test_lod);
+    TEST_CASE(test_trilinear_minification);
+    TEST_CASE(test_tiled_layout);
+    TEST_CASE(test_formats);
+    TEST_CASE(test_bilinear_blend);
+    TEST_CASE(test_wrap_modes);
+    TEST_CASE(test_anisotropic);
+    TEST_CASE(test_compressed);
+}
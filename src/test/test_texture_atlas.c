@@ -0,0 +1,176 @@
+#include "test_texture_atlas.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "test_utils.h"
+#include "../settings.h"
+#include "../texture_atlas.h"
+
+static texture_t* small_texture(uint32_t seed, texture_wrap_e wrap)
+{
+    // converted, mipmapped and tiled like the loader does
+    texture_t* texture  = texture_new(16, 8, 3, TEXTURE_LAYOUT_LINEAR);
+
+    for (uint32_t i = 0; i < 16 * 8 * 3; i++)
+    {
+        texture->data[i] = (unsigned char)((i + seed) * 2654435761u >> 24);
+    }
+
+    texture_set_format(texture, TEXTURE_FORMAT_RG8);
+    texture_generate_mips(texture);
+    texture_set_layout(texture, TEXTURE_LAYOUT_TILED);
+    texture_set_wrap(texture, wrap, wrap);
+
+    return texture;
+}
+
+static texture_t* flat_texture(unsigned char value)
+{
+    texture_t* texture  = texture_new(16, 8, 3, TEXTURE_LAYOUT_LINEAR);
+
+    memset(texture->data, value, 16 * 8 * 3);
+
+    texture_set_format(texture, TEXTURE_FORMAT_RG8);
+    texture_generate_mips(texture);
+    texture_set_layout(texture, TEXTURE_LAYOUT_TILED);
+
+    return texture;
+}
+
+static void assert_same_samples(texture_t* packed, texture_t* reference, vec2_t duv)
+{
+    // 8.8 bilinear weights come from different coordinates, they can be a step apart
+    for (uint32_t i = 0; i < 24; i++)
+    {
+        float u     = -0.3f + (float)i * 0.07f;
+        float v     = 1.2f - (float)i * 0.061f;
+        vec4_t a    = texture_sample(packed, u, v, duv, duv);
+        vec4_t b    = texture_sample(reference, u, v, duv, duv);
+
+        ASSERT_TRUE(fabsf(a.x - b.x) < 0.01f && fabsf(a.y - b.y) < 0.01f);
+    }
+}
+
+static void test_packed_samples()
+{
+    texture_filter_e filter     = get_texture_filter();
+    texture_wrap_e wraps[3]     = { TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_CLAMP, TEXTURE_WRAP_MIRROR };
+
+    for (uint32_t w = 0; w < 3; w++)
+    {
+        texture_t* reference    = small_texture(w, wraps[w]);
+        texture_t* texture      = small_texture(w, wraps[w]);
+
+        ASSERT_TRUE(texture_atlas_add(texture));
+        ASSERT_TRUE(texture->atlas != NULL && texture->data == NULL);
+        ASSERT_EQUAL(texture_memory_size(texture), 0);
+
+        // past the edges the gutters give what the wrap mode reads, minification stays within the page levels
+        while (get_texture_filter() != BILINEAR_SAMPLE)
+        {
+            change_texture_filter();
+        }
+
+        assert_same_samples(texture, reference, vec2_new(0.f, 0.f));
+
+        while (get_texture_filter() != TRILINEAR_SAMPLE)
+        {
+            change_texture_filter();
+        }
+
+        assert_same_samples(texture, reference, vec2_new(0.1f, 0.1f));
+
+        texture_atlas_remove(texture);
+        texture_free(texture);
+        texture_free(reference);
+    }
+
+    while (get_texture_filter() != filter)
+    {
+        change_texture_filter();
+    }
+}
+
+static void test_anisotropic_neighbours()
+{
+    texture_filter_e filter     = get_texture_filter();
+    texture_t* dark             = flat_texture(0);
+    texture_t* bright           = flat_texture(255);
+
+    // packed next to each other, only the two gutters are between them
+    ASSERT_TRUE(texture_atlas_add(dark));
+    ASSERT_TRUE(texture_atlas_add(bright));
+    ASSERT_TRUE(dark->atlas == bright->atlas && bright->atlas_x > dark->atlas_x);
+
+    while (get_texture_filter() != ANISOTROPIC_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    // footprints two texture sizes long along either axis, the probes wrap inside the dark texture
+    vec2_t longs[2]             = { vec2_new(2.f, 0.f), vec2_new(0.f, 2.f) };
+    vec2_t shorts[2]            = { vec2_new(0.f, 0.02f), vec2_new(0.02f, 0.f) };
+    float max                   = 0.f;
+
+    for (uint32_t a = 0; a < 2; a++)
+    {
+        for (uint32_t i = 0; i <= 20; i++)
+        {
+            vec4_t texel    = texture_sample(dark, (float)i * 0.05f, 1.f - (float)i * 0.05f, longs[a], shorts[a]);
+            max             = fmaxf(max, fmaxf(texel.x, texel.y));
+        }
+    }
+
+    ASSERT_TRUE(max < 0.01f);
+
+    while (get_texture_filter() != filter)
+    {
+        change_texture_filter();
+    }
+
+    texture_atlas_remove(dark);
+    texture_atlas_remove(bright);
+    texture_free(dark);
+    texture_free(bright);
+}
+
+static void test_shared_pages()
+{
+    texture_t* a                = small_texture(1, TEXTURE_WRAP_REPEAT);
+    texture_t* b                = small_texture(2, TEXTURE_WRAP_REPEAT);
+    texture_t* large            = texture_new(ATLAS_MAX_TEXTURE_SIZE * 2, 8, 3, TEXTURE_LAYOUT_LINEAR);
+    texture_generate_mips(large);
+
+    ASSERT_TRUE(texture_atlas_add(a));
+    ASSERT_TRUE(texture_atlas_add(b));
+    ASSERT_TRUE(!texture_atlas_add(large));
+    ASSERT_TRUE(a->atlas == b->atlas);
+    ASSERT_TRUE(a->atlas_x != b->atlas_x || a->atlas_y != b->atlas_y);
+
+    texture_atlas_stats_t stats = texture_atlas_stats();
+    uint32_t padded             = (16 + 2 * ATLAS_GUTTER) * (8 + 2 * ATLAS_GUTTER);
+
+    ASSERT_EQUAL(stats.textures, 2);
+    ASSERT_EQUAL(stats.pages, 1);
+    ASSERT_TRUE(stats.used_texels == 2 * padded);
+    ASSERT_TRUE(stats.page_texels == ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE);
+
+    // the page goes with its last texture
+    texture_atlas_remove(a);
+    ASSERT_EQUAL(texture_atlas_stats().pages, 1);
+
+    texture_atlas_remove(b);
+    ASSERT_EQUAL(texture_atlas_stats().pages, 0);
+
+    texture_free(a);
+    texture_free(b);
+    texture_free(large);
+}
+
+void test_texture_atlas()
+{
+    TEST_CASE(test_packed_samples);
+    TEST_CASE(test_anisotropic_neighbours);
+    TEST_CASE(test_shared_pages);
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "test_texture_manager.h"
+
+#include <string.h>
+
+#include "test_utils.h"
+#include "../texture_manager.h"
+
+static void test_hash()
+{
+    unsigned char a[] = { 1, 2, 3, 4 };
+    unsigned char b[] = { 1, 2, 3, 5 };
+
+    ASSERT_TRUE(texture_manager_hash(a, 4) == texture_manager_hash(a, 4));
+    ASSERT_TRUE(texture_manager_hash(a, 4) != texture_manager_hash(b, 4));
+}
+
+static void test_shared_references()
+{
+    uint32_t count      = texture_manager_count();
+    uint64_t hash       = 0x1234;
+    texture_t* texture  = texture_new(4, 4, 3, TEXTURE_LAYOUT_LINEAR);
+    texture_set_format(texture, TEXTURE_FORMAT_RG8);
+
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_RG8, false, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_REPEAT) == NULL);
+
+    texture_manager_add(hash, texture);
+    ASSERT_EQUAL(texture_manager_count(), count + 1);
+
+    // same image, format and sampler is shared, another format, compression or wrap mode is a different texture
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_RG8, false, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_REPEAT) == texture);
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_R8, false, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_REPEAT) == NULL);
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_RG8, true, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_REPEAT) == NULL);
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_RG8, false, TEXTURE_WRAP_CLAMP, TEXTURE_WRAP_REPEAT) == NULL);
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_RG8, false, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_MIRROR) == NULL);
+
+    // two owners now, the first release keeps the texture alive
+    texture_manager_release(texture);
+    ASSERT_EQUAL(texture_manager_count(), count + 1);
+
+    texture_manager_release(texture);
+    ASSERT_EQUAL(texture_manager_count(), count);
+    ASSERT_TRUE(texture_manager_find(hash, TEXTURE_FORMAT_RG8, false, TEXTURE_WRAP_REPEAT, TEXTURE_WRAP_REPEAT) == NULL);
+}
+
+static void test_copy()
+{
+    texture_t* texture  = texture_new(8, 8, 3, TEXTURE_LAYOUT_LINEAR);
+
+    for (uint32_t i = 0; i < 8 * 8 * 3; i++)
+    {
+        texture->data[i] = (unsigned char)i;
+    }
+
+    texture_t* copy     = texture_copy(texture);
+
+    ASSERT_TRUE(copy->data != texture->data);
+    ASSERT_EQUAL(copy->width, texture->width);
+    ASSERT_EQUAL(copy->height, texture->height);
+    ASSERT_EQUAL(copy->stride, texture->stride);
+    ASSERT_TRUE(memcmp(copy->data, texture->data, 8 * 8 * 3) == 0);
+
+    texture_free(copy);
+    texture_free(texture);
+}
+
+void test_texture_manager()
+{
+    TEST_CASE(test_hash);
+    TEST_CASE(test_shared_references);
+    TEST_CASE(test_copy);
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_texture_manager();
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "test_texture_stream.h"
+
+#include <string.h>
+
+#include "test_utils.h"
+#include "../settings.h"
+#include "../texture_stream.h"
+#include "../parsers/png.h"
+
+// 2x5 rgb image from test_png, its chain is 2x5, 1x2 and 1x1
+static const unsigned char image[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a,
+    0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+    0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x05,
+    0x08, 0x02, 0x00, 0x00, 0x00,
+    0xe0, 0xd1, 0xaa, 0xcb,
+    0x00, 0x00, 0x00, 0x1d, 0x49, 0x44, 0x41, 0x54,
+    0x78, 0xda,
+    0x1d, 0xc6, 0x49, 0x01, 0x00, 0x00, 0x10, 0x40,
+    0xc0, 0xac, 0xa3, 0x7f, 0x88, 0x3d, 0x3c, 0x20,
+    0x2a, 0x97, 0x9d, 0x37, 0x5e, 0x1d, 0x0c,
+    0x00, 0x00, 0x00, 0x00,
+    0xfc, 0xca, 0x79, 0xd8,
+    0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44,
+    0xae, 0x42, 0x60, 0x82
+};
+
+static void test_streamed_levels()
+{
+    texture_filter_e filter = get_texture_filter();
+    uint32_t budget         = get_texture_budget();
+
+    while (get_texture_filter() != BILINEAR_SAMPLE)
+    {
+        change_texture_filter();
+    }
+
+    texture_t* reference    = parse_png_texture(image, sizeof(image), TEXTURE_FORMAT_RG8, false, TEXTURE_LAYOUT_TILED);
+    texture_t* texture      = texture_copy(reference);
+    vec2_t d                = vec2_new(0.f, 0.f);
+
+    // only the 1x1 level stays at load, samples fall back to it
+    texture_stream_add(texture, image, sizeof(image), 1);
+
+    ASSERT_EQUAL(texture->resident, 2);
+    ASSERT_EQUAL(texture_stream_memory_size(), texture->stride * TEXTURE_TILE_SIZE * TEXTURE_TILE_SIZE);
+    ASSERT_TRUE(texture->data == NULL);
+
+    vec4_t coarse           = texture_sample(texture, 0.3f, 0.6f, d, d);
+    vec4_t expected         = texture_sample(reference, 0.3f, 0.6f, d, d);
+    ASSERT_EQUAL(coarse.x, reference->mips[2].data[0] / 255.f);
+
+    // the request of the sample above is decoded in the background and installed
+    texture_stream_update();
+    texture_stream_flush();
+
+    ASSERT_EQUAL(texture->resident, 0);
+    ASSERT_EQUAL(texture_memory_size(texture), texture_memory_size(reference));
+
+    vec4_t fine             = texture_sample(texture, 0.3f, 0.6f, d, d);
+    ASSERT_EQUAL(fine.x, expected.x);
+    ASSERT_EQUAL(fine.y, expected.y);
+
+    // levels sampled in the current frame survive an exceeded budget, the next frame evicts them
+    set_texture_budget(0);
+    texture_stream_update();
+    ASSERT_EQUAL(texture->resident, 0);
+
+    texture_stream_update();
+    ASSERT_EQUAL(texture->resident, 2);
+
+    texture_stream_remove(texture);
+    texture_free(texture);
+    texture_free(reference);
+
+    set_texture_budget(budget);
+
+    while (get_texture_filter() != filter)
+    {
+        change_texture_filter();
+    }
+}
+
+void test_texture_stream()
+{
+    TEST_CASE(test_streamed_levels);
+}
\ No newline at end of file
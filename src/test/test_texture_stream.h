@@ -0,0 +1,3 @@
+#pragma once
+
+void test_texture_stream();
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "test_vrs.h"
+
+#include "test_utils.h"
+#include "../vrs.h"
+
+static void test_flat_frame_is_coarse()
+{
+    framebuffer_t* frame    = framebuffer_new(64, 64);
+    vrs_map_t* map          = vrs_map_new(64, 64);
+
+    ASSERT_EQUAL(vrs_map_get(map, 10, 10), SHADING_RATE_1X1);
+
+    vrs_map_update(map, frame);
+
+    for (uint32_t i = 0; i < map->tiles_x * map->tiles_y; i++)
+    {
+        ASSERT_EQUAL((uint32_t)map->rates[i], (uint32_t)SHADING_RATE_4X4);
+    }
+
+    vrs_map_free(map);
+    framebuffer_free(frame);
+}
+
+static void test_edges_are_full_rate()
+{
+    framebuffer_t* frame    = framebuffer_new(64, 64);
+    vrs_map_t* map          = vrs_map_new(64, 64);
+
+    // hard colour edges in the top left tile only, same brightness on both sides
+    for (uint32_t y = 0; y < VRS_TILE_SIZE; y++)
+    {
+        for (uint32_t x = 0; x < VRS_TILE_SIZE; x++)
+        {
+            framebuffer_set(frame, x, y, (x / 4) % 2 ? 0x000000FF : 0x00FF0000);
+        }
+    }
+
+    vrs_map_update(map, frame);
+
+    ASSERT_EQUAL(vrs_map_get(map, 0, 0), SHADING_RATE_1X1);
+    ASSERT_EQUAL(vrs_map_get(map, 40, 40), SHADING_RATE_4X4);
+
+    vrs_map_free(map);
+    framebuffer_free(frame);
+}
+
+static void test_coarse_frame_keeps_rate()
+{
+    framebuffer_t* frame    = framebuffer_new(64, 64);
+    vrs_map_t* fine         = vrs_map_new(64, 64);
+    vrs_map_t* coarse       = vrs_map_new(64, 64);
+
+    // the same gradient, 2 per two pixels, shaded per pixel and shaded once per 4x4 coarse pixel
+    for (uint32_t y = 0; y < 64; y++)
+    {
+        for (uint32_t x = 0; x < 64; x++)
+        {
+            framebuffer_set(frame, x, y, x + y);
+        }
+    }
+
+    vrs_map_update(fine, frame);
+
+    framebuffer_clear(frame);
+    vrs_map_update(coarse, frame);
+    ASSERT_EQUAL(vrs_map_get(coarse, 20, 20), SHADING_RATE_4X4);
+
+    for (uint32_t y = 0; y < 64; y++)
+    {
+        for (uint32_t x = 0; x < 64; x++)
+        {
+            framebuffer_set(frame, x, y, (x & ~3u) + (y & ~3u));
+        }
+    }
+
+    vrs_map_update(coarse, frame);
+
+    ASSERT_EQUAL(vrs_map_get(fine, 20, 20), SHADING_RATE_2X2);
+    ASSERT_EQUAL(vrs_map_get(coarse, 20, 20), SHADING_RATE_2X2);
+
+    // hard edges between coarse pixels go back to full rate
+    for (uint32_t y = 0; y < 64; y++)
+    {
+        for (uint32_t x = 0; x < 64; x++)
+        {
+            framebuffer_set(frame, x, y, (x / 4 + y / 4) % 2 ? 0x00FFFFFF : 0);
+        }
+    }
+
+    vrs_map_update(coarse, frame);
+    vrs_map_update(coarse, frame);
+
+    ASSERT_EQUAL(vrs_map_get(coarse, 20, 20), SHADING_RATE_1X1);
+
+    vrs_map_free(coarse);
+    vrs_map_free(fine);
+    framebuffer_free(frame);
+}
+
+static void test_coarse_cells()
+{
+    vrs_map_t* map = vrs_map_new(64, 64);
+
+    ASSERT_EQUAL(vrs_map_cell(map, 5, 6, SHADING_RATE_2X2), vrs_map_cell(map, 4, 7, SHADING_RATE_2X2));
+    ASSERT_TRUE(vrs_map_cell(map, 5, 6, SHADING_RATE_2X2) != vrs_map_cell(map, 6, 6, SHADING_RATE_2X2));
+    ASSERT_EQUAL(vrs_map_cell(map, 7, 7, SHADING_RATE_4X4), vrs_map_cell(map, 4, 4, SHADING_RATE_4X4));
+    ASSERT_TRUE(vrs_map_next_stamp(map) != vrs_map_next_stamp(map));
+
+    vrs_map_free(map);
+}
+
+void test_vrs()
+{
+    TEST_CASE(test_flat_frame_is_coarse);
+    TEST_CASE(test_edges_are_full_rate);
+    TEST_CASE(test_coarse_frame_keeps_rate);
+    TEST_CASE(test_coarse_cells);
+}
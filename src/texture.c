@@ -1,97 +1,1157 @@
 #include "texture.h"
 
+#include <math.h>
+#include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <threads.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "bc.h"
 #include "settings.h"
+#include "atomic_types.h"
 
 /********************
  *  Notes
  *
+ * Textures are decoded as R G B (A) bytes and converted once at load to a format that suits their role, see
+ * texture_format_e. Albedo is stored linear with 16 bits per channel so the shader no longer has to undo the
+ * sRGB curve per sample and dark values keep their precision, the other maps drop the channels they do not use.
+ *
+ * Bilinear filtering blends the 2x2 footprint with SSE2 integer multiplies. 8 bit formats are widened to 16 bit
+ * lanes and use 8.8 fixed point weights, the 16 bit albedo uses 0.16 weights with a high multiply instead.
+ * Builds without SSE2 fall back to the float path.
+ *
+ * Coordinates outside [0, 1] follow the glTF wrap modes. Power of two textures (and with them every mip level)
+ * wrap with a mask, other sizes take a modulo.
+ *
+ * Anisotropic filtering takes up to get_max_anisotropy() trilinear probes along the major axis of the pixel
+ * footprint, the number of probes follows the ratio between the axes.
+ *
+ * texture_compress encodes every level to 4x4 blocks, BC1 for color (albedo goes back to sRGB first), BC4 for
+ * occlusion and BC5 for metal/rough and the x y of normals, z is rebuilt when decoding. Samplers decode the whole
+ * block a texel falls into and keep it in a small per thread cache keyed by the block address, freeing any
+ * texture bumps an epoch that invalidates all entries since a new texture may reuse the memory.
+ *
+ * Streamed textures (see texture_stream.c) can miss their finer levels. Samplers record the finest level they
+ * wanted and fall back to the finest resident one.
+ *
+ * Packed textures (see texture_atlas.c) keep no texels of their own. Their coordinates are wrapped inside the
+ * texture and then moved into its rectangle of the atlas page, the gutters around it hold the texels the wrap
+ * mode reads past the edges so bilinear footprints match the unpacked texture. Anisotropic probes are spread
+ * and wrapped in the packed texture's own coordinates, however long the footprint only single bilinear
+ * footprints reach into the gutter.
  ********************/
 
 /********************/
 /*      defines     */
 /********************/
 
+#define SRGB_GAMMA          2.2f
+#define BLOCK_CACHE_SIZE    64          // entries per thread, power of two
+
 /********************/
 /* static variables */
 /********************/
 
+typedef struct
+{
+    const unsigned char*    block;
+    uint32_t                epoch;
+    vec4_t                  texels[BC_BLOCK_TEXELS];
+} block_cache_entry_t;
+
+static thread_local block_cache_entry_t block_cache[BLOCK_CACHE_SIZE]  = { 0 };
+static atomic_uint32_t block_epoch                                      = 1;
+
+static once_flag srgb_once                                              = ONCE_FLAG_INIT;
+static float srgb_to_linear[256];
+
 /********************/
 /* static functions */
 /********************/
 
-static vec4_t sample(texture_t* texture, uint32_t x, uint32_t y)
+static uint32_t level_size(const texture_level_t* level, texture_layout_e layout)
+{
+    if (layout == TEXTURE_LAYOUT_TILED)
+    {
+        uint32_t tiles_x = (level->width + TEXTURE_TILE_SIZE - 1) >> TEXTURE_TILE_SHIFT;
+        uint32_t tiles_y = (level->height + TEXTURE_TILE_SIZE - 1) >> TEXTURE_TILE_SHIFT;
+
+        return (tiles_x * tiles_y) << (2 * TEXTURE_TILE_SHIFT);
+    }
+
+    return level->width * level->height;
+}
+
+static inline uint32_t address(int32_t x, uint32_t size, texture_wrap_e wrap, bool pot)
+{
+    // maps any texel coordinate into [0, size), power of two sizes wrap with a mask
+    int32_t n = (int32_t)size;
+
+    if (wrap == TEXTURE_WRAP_CLAMP)
+    {
+        return (uint32_t)(x < 0 ? 0 : (x >= n ? n - 1 : x));
+    }
+
+    if (wrap == TEXTURE_WRAP_MIRROR)
+    {
+        int32_t m = pot ? (int32_t)((uint32_t)x & (2 * size - 1)) : ((x % (2 * n)) + 2 * n) % (2 * n);
+
+        return (uint32_t)(m < n ? m : 2 * n - 1 - m);
+    }
+
+    return pot ? (uint32_t)x & (size - 1) : (uint32_t)(((x % n) + n) % n);
+}
+
+static inline float wrap_coord(float u, texture_wrap_e wrap)
+{
+    // address() for normalized coordinates
+    if (wrap == TEXTURE_WRAP_CLAMP)
+    {
+        return f_min(f_max(u, 0.f), 1.f);
+    }
+
+    if (wrap == TEXTURE_WRAP_MIRROR)
+    {
+        float m = u - 2.f * floorf(u * 0.5f);
+
+        return m > 1.f ? 2.f - m : m;
+    }
+
+    return u - floorf(u);
+}
+
+static inline int32_t floor_int(float x)
+{
+    int32_t i = (int32_t)x;
+
+    return i - (x < (float)i);
+}
+
+static void srgb_init()
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        srgb_to_linear[i] = f_pow((float)i / 255.f, SRGB_GAMMA);
+    }
+}
+
+static uint32_t block_bytes(texture_format_e format)
+{
+    switch (format)
+    {
+        case TEXTURE_FORMAT_RG8:
+        case TEXTURE_FORMAT_XYZ8_SNORM:
+            return BC5_BLOCK_BYTES;
+        case TEXTURE_FORMAT_R8:
+            return BC4_BLOCK_BYTES;
+        default:
+            return BC1_BLOCK_BYTES;
+    }
+}
+
+static uint32_t level_blocks(const texture_level_t* level)
+{
+    return ((level->width + BC_BLOCK_SIZE - 1) / BC_BLOCK_SIZE) * ((level->height + BC_BLOCK_SIZE - 1) / BC_BLOCK_SIZE);
+}
+
+static void block_decode(texture_format_e format, const unsigned char* block, vec4_t texels[BC_BLOCK_TEXELS])
+{
+    const float d = 1.f / 255.f;
+
+    if (format == TEXTURE_FORMAT_R8)
+    {
+        unsigned char values[BC_BLOCK_TEXELS];
+        bc4_decode(block, values);
+
+        for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+        {
+            texels[i] = vec4_new(0.f, 0.f, (float)values[i] * d);
+        }
+    }
+    else if (format == TEXTURE_FORMAT_RG8 || format == TEXTURE_FORMAT_XYZ8_SNORM)
+    {
+        unsigned char rg[BC_BLOCK_TEXELS * 2];
+        bc5_decode(block, rg);
+
+        for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+        {
+            if (format == TEXTURE_FORMAT_RG8)
+            {
+                texels[i] = vec4_new((float)rg[i * 2 + 0] * d, (float)rg[i * 2 + 1] * d, 0.f);
+                continue;
+            }
+
+            // normals are stored biased, z is positive in tangent space
+            float x     = ((float)rg[i * 2 + 0] - 128.f) / 127.f;
+            float y     = ((float)rg[i * 2 + 1] - 128.f) / 127.f;
+            texels[i]   = vec4_new(x, y, sqrtf(f_max(1.f - x * x - y * y, 0.f)));
+        }
+    }
+    else
+    {
+        unsigned char rgb[BC_BLOCK_TEXELS * 3];
+        bc1_decode(block, rgb);
+
+        for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+        {
+            if (format == TEXTURE_FORMAT_RGB16_LINEAR)
+            {
+                texels[i] = vec4_new(srgb_to_linear[rgb[i * 3 + 2]], srgb_to_linear[rgb[i * 3 + 1]], srgb_to_linear[rgb[i * 3 + 0]]);
+            }
+            else
+            {
+                texels[i] = vec4_new((float)rgb[i * 3 + 2] * d, (float)rgb[i * 3 + 1] * d, (float)rgb[i * 3 + 0] * d);
+            }
+        }
+    }
+}
+
+static const vec4_t* block_lookup(const texture_t* texture, const texture_level_t* level, uint32_t x, uint32_t y)
+{
+    // decoded texels of the block containing x, y
+    uint32_t blocks_x               = (level->width + BC_BLOCK_SIZE - 1) / BC_BLOCK_SIZE;
+    uint32_t index                  = (y / BC_BLOCK_SIZE) * blocks_x + x / BC_BLOCK_SIZE;
+    const unsigned char* block      = &level->data[index * texture->stride];
+
+    uintptr_t key                   = (uintptr_t)block / BC4_BLOCK_BYTES;
+    block_cache_entry_t* entry      = &block_cache[(key ^ (key >> 6)) & (BLOCK_CACHE_SIZE - 1)];
+    uint32_t epoch                  = atomic_load_explicit(&block_epoch, memory_order_relaxed);
+
+    if (entry->block != block || entry->epoch != epoch)
+    {
+        block_decode(texture->format, block, entry->texels);
+        entry->block                = block;
+        entry->epoch                = epoch;
+    }
+
+    return entry->texels;
+}
+
+static vec4_t block_texel(const texture_t* texture, const texture_level_t* level, uint32_t x, uint32_t y)
+{
+    return block_lookup(texture, level, x, y)[(y % BC_BLOCK_SIZE) * BC_BLOCK_SIZE + x % BC_BLOCK_SIZE];
+}
+
+static vec4_t sample(const texture_t* texture, const texture_level_t* level, uint32_t x, uint32_t y)
+{
+    // samplers are specialized per format, the result is always B G R except for normals which are x y z
+    if (texture->compressed)
+    {
+        return block_texel(texture, level, x, y);
+    }
+
+    uint32_t index      = texture_texel_index(texture, level, x, y);
+    const float d8      = 1.f / 255.f;
+
+    switch (texture->format)
+    {
+        case TEXTURE_FORMAT_RGB16_LINEAR:
+        {
+            const uint16_t* texel = (const uint16_t*)level->data + index * 3;
+            const float d16       = 1.f / 65535.f;
+
+            return vec4_new((float)texel[0] * d16, (float)texel[1] * d16, (float)texel[2] * d16);
+        }
+        case TEXTURE_FORMAT_RG8:
+        {
+            const unsigned char* texel = &level->data[index * 2];
+
+            return vec4_new((float)texel[0] * d8, (float)texel[1] * d8, 0.f);
+        }
+        case TEXTURE_FORMAT_R8:
+        {
+            return vec4_new(0.f, 0.f, (float)level->data[index] * d8);
+        }
+        case TEXTURE_FORMAT_XYZ8_SNORM:
+        {
+            const signed char* texel = (const signed char*)&level->data[index * 3];
+            const float d            = 1.f / 127.f;
+
+            return vec4_new((float)texel[0] * d, (float)texel[1] * d, (float)texel[2] * d);
+        }
+        case TEXTURE_FORMAT_RGB8:
+        default:
+        {
+            const unsigned char* texel = &level->data[index * texture->stride];
+
+            return vec4_new((float)texel[2] * d8, (float)texel[1] * d8, (float)texel[0] * d8);
+        }
+    }
+}
+
+static void texel_convert(texture_format_e format, const unsigned char* in, unsigned char* out, const uint16_t* linear)
+{
+    switch (format)
+    {
+        case TEXTURE_FORMAT_RGB16_LINEAR:
+        {
+            uint16_t* texel = (uint16_t*)out;
+            texel[0]        = linear[in[2]];
+            texel[1]        = linear[in[1]];
+            texel[2]        = linear[in[0]];
+            break;
+        }
+        case TEXTURE_FORMAT_RG8:
+        {
+            out[0]          = in[2];
+            out[1]          = in[1];
+            break;
+        }
+        case TEXTURE_FORMAT_R8:
+        {
+            out[0]          = in[0];
+            break;
+        }
+        case TEXTURE_FORMAT_XYZ8_SNORM:
+        {
+            // [0, 255] -> [-127, 127]
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                out[c]      = (unsigned char)(signed char)f_round(((float)in[c] * (2.f / 255.f) - 1.f) * 127.f);
+            }
+            break;
+        }
+        case TEXTURE_FORMAT_RGB8:
+        default:
+            assert(false);
+    }
+}
+
+static vec4_t blend_float(const texture_t* texture,
+                          const texture_level_t* level,
+                          uint32_t x1,
+                          uint32_t y1,
+                          uint32_t x2,
+                          uint32_t y2,
+                          float fx,
+                          float fy)
+{
+    // reference path, also used for compressed textures whose texels come from the block cache
+    vec4_t f_x1y1, f_x1y2, f_x2y1, f_x2y2;
+
+    if (texture->compressed && x1 / BC_BLOCK_SIZE == x2 / BC_BLOCK_SIZE && y1 / BC_BLOCK_SIZE == y2 / BC_BLOCK_SIZE)
+    {
+        // most footprints fall inside one block, look it up once
+        const vec4_t* texels    = block_lookup(texture, level, x1, y1);
+        uint32_t mask           = BC_BLOCK_SIZE - 1;
+
+        f_x1y1                  = texels[(y1 & mask) * BC_BLOCK_SIZE + (x1 & mask)];
+        f_x1y2                  = texels[(y2 & mask) * BC_BLOCK_SIZE + (x1 & mask)];
+        f_x2y1                  = texels[(y1 & mask) * BC_BLOCK_SIZE + (x2 & mask)];
+        f_x2y2                  = texels[(y2 & mask) * BC_BLOCK_SIZE + (x2 & mask)];
+    }
+    else
+    {
+        f_x1y1                  = sample(texture, level, x1, y1);
+        f_x1y2                  = sample(texture, level, x1, y2);
+        f_x2y1                  = sample(texture, level, x2, y1);
+        f_x2y2                  = sample(texture, level, x2, y2);
+    }
+
+    vec4_t f_xy1    = vec4_add(vec4_scale(f_x1y1, 1.f - fx), vec4_scale(f_x2y1, fx));
+    vec4_t f_xy2    = vec4_add(vec4_scale(f_x1y2, 1.f - fx), vec4_scale(f_x2y2, fx));
+
+    return vec4_add(vec4_scale(f_xy1, 1.f - fy), vec4_scale(f_xy2, fy));
+}
+
+#if defined(__SSE2__)
+
+static inline uint32_t texel_load8(texture_format_e format, const unsigned char* texel)
+{
+    // assembled in registers, a 3 byte copy through memory stalls store forwarding. Alpha is never read
+    if (format == TEXTURE_FORMAT_R8)
+    {
+        return texel[0];
+    }
+
+    uint16_t lo;
+    memcpy(&lo, texel, 2);
+
+    switch (format)
+    {
+        case TEXTURE_FORMAT_RG8:
+            return lo;
+        case TEXTURE_FORMAT_XYZ8_SNORM:
+            // signed normals are biased to unsigned so all formats share the blend
+            return ((uint32_t)lo | (uint32_t)texel[2] << 16) ^ 0x808080;
+        default:
+            return (uint32_t)lo | (uint32_t)texel[2] << 16;
+    }
+}
+
+static inline __m128i footprint_load8(texture_format_e format,
+                                      const unsigned char* data,
+                                      uint32_t stride,
+                                      const uint32_t index[4])
+{
+    // the 2x2 footprint as 16 packed bytes, x1y1 x2y1 x1y2 x2y2
+    return _mm_set_epi32((int32_t)texel_load8(format, &data[index[3] * stride]),
+                         (int32_t)texel_load8(format, &data[index[2] * stride]),
+                         (int32_t)texel_load8(format, &data[index[1] * stride]),
+                         (int32_t)texel_load8(format, &data[index[0] * stride]));
+}
+
+static inline __m128i lerp_halves8(__m128i v, uint16_t w)
+{
+    // lanes 0-3 = (lanes 0-3 * (256 - w) + lanes 4-7 * w) >> 8, weights in 8.8 fixed point
+    // 255 * 256 + 128 still fits the 16 bit lanes
+    short w0        = (short)(256 - w);
+    short w1        = (short)w;
+    __m128i weights = _mm_set_epi16(w1, w1, w1, w1, w0, w0, w0, w0);
+
+    v               = _mm_mullo_epi16(v, weights);
+    v               = _mm_add_epi16(v, _mm_srli_si128(v, 8));
+
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_set1_epi16(128)), 8);
+}
+
+static inline __m128i lerp_halves16(__m128i v, uint16_t w)
+{
+    // same for full 16 bit lanes, the weights are 0.16 fixed point and kept inside [1, 65535]
+    short w0        = (short)(uint16_t)(65536 - w);
+    short w1        = (short)w;
+    __m128i weights = _mm_set_epi16(w1, w1, w1, w1, w0, w0, w0, w0);
+
+    v               = _mm_mulhi_epu16(v, weights);
+
+    return _mm_add_epi16(v, _mm_srli_si128(v, 8));
+}
+
+static inline __m128i load16(const unsigned char* texel)
+{
+    uint32_t lo;
+    uint16_t hi;
+    memcpy(&lo, texel, 4);
+    memcpy(&hi, texel + 4, 2);
+
+    return _mm_insert_epi16(_mm_cvtsi32_si128((int32_t)lo), hi, 2);
+}
+
+static vec4_t blend_bilinear(const texture_t* texture,
+                             const texture_level_t* level,
+                             uint32_t x1,
+                             uint32_t y1,
+                             uint32_t x2,
+                             uint32_t y2,
+                             float fx,
+                             float fy)
+{
+    if (texture->compressed)
+    {
+        return blend_float(texture, level, x1, y1, x2, y2, fx, fy);
+    }
+
+    const unsigned char* data   = level->data;
+    uint32_t stride             = texture->stride;
+    uint32_t index[4]           = { texture_texel_index(texture, level, x1, y1),
+                                    texture_texel_index(texture, level, x2, y1),
+                                    texture_texel_index(texture, level, x1, y2),
+                                    texture_texel_index(texture, level, x2, y2) };
+    __m128i zero                = _mm_setzero_si128();
+    __m128 scale                = _mm_set1_ps(1.f / 255.f);
+    __m128 bias                 = _mm_setzero_ps();
+    __m128i col;
+
+    if (texture->format == TEXTURE_FORMAT_RGB16_LINEAR)
+    {
+        uint16_t wx             = (uint16_t)(fx * 65534.f) + 1;
+        uint16_t wy             = (uint16_t)(fy * 65534.f) + 1;
+        __m128i top             = _mm_unpacklo_epi64(load16(&data[index[0] * 6]), load16(&data[index[1] * 6]));
+        __m128i bottom          = _mm_unpacklo_epi64(load16(&data[index[2] * 6]), load16(&data[index[3] * 6]));
+
+        col                     = lerp_halves16(_mm_unpacklo_epi64(lerp_halves16(top, wx), lerp_halves16(bottom, wx)), wy);
+        scale                   = _mm_set1_ps(1.f / 65535.f);
+    }
+    else
+    {
+        uint16_t wx             = (uint16_t)(fx * 256.f + 0.5f);
+        uint16_t wy             = (uint16_t)(fy * 256.f + 0.5f);
+        __m128i texels;
+
+        // one load per format so the switch is not repeated per texel
+        switch (texture->format)
+        {
+            case TEXTURE_FORMAT_R8:         texels = footprint_load8(TEXTURE_FORMAT_R8, data, stride, index); break;
+            case TEXTURE_FORMAT_RG8:        texels = footprint_load8(TEXTURE_FORMAT_RG8, data, stride, index); break;
+            case TEXTURE_FORMAT_XYZ8_SNORM: texels = footprint_load8(TEXTURE_FORMAT_XYZ8_SNORM, data, stride, index); break;
+            default:                        texels = footprint_load8(TEXTURE_FORMAT_RGB8, data, stride, index); break;
+        }
+
+        __m128i top             = lerp_halves8(_mm_unpacklo_epi8(texels, zero), wx);
+        __m128i bottom          = lerp_halves8(_mm_unpackhi_epi8(texels, zero), wx);
+
+        col                     = lerp_halves8(_mm_unpacklo_epi64(top, bottom), wy);
+
+        // lanes to B G R, undo the bias of the normals
+        if (texture->format == TEXTURE_FORMAT_RGB8)
+        {
+            col                 = _mm_shufflelo_epi16(col, _MM_SHUFFLE(3, 0, 1, 2));
+        }
+        else if (texture->format == TEXTURE_FORMAT_R8)
+        {
+            col                 = _mm_shufflelo_epi16(col, _MM_SHUFFLE(1, 0, 1, 1));
+        }
+        else if (texture->format == TEXTURE_FORMAT_XYZ8_SNORM)
+        {
+            scale               = _mm_set1_ps(1.f / 127.f);
+            bias                = _mm_set1_ps(-128.f / 127.f);
+        }
+    }
+
+    __m128 f                    = _mm_cvtepi32_ps(_mm_unpacklo_epi16(col, zero));
+    f                           = _mm_add_ps(_mm_mul_ps(f, scale), bias);
+
+    float out[4];
+    _mm_storeu_ps(out, f);
+
+    return vec4_new(out[0], out[1], out[2]);
+}
+
+#else
+
+static vec4_t blend_bilinear(const texture_t* texture,
+                             const texture_level_t* level,
+                             uint32_t x1,
+                             uint32_t y1,
+                             uint32_t x2,
+                             uint32_t y2,
+                             float fx,
+                             float fy)
+{
+    return blend_float(texture, level, x1, y1, x2, y2, fx, fy);
+}
+
+#endif
+
+static vec4_t sample_bilinear(const texture_t* texture, const texture_level_t* level, float u, float v)
+{
+    // texel centers are at +0.5, both neighbours go through the wrap modes of the texture
+    float x         = u * (float)level->width - 0.5f;
+    float y         = v * (float)level->height - 0.5f;
+    int32_t xi      = floor_int(x);
+    int32_t yi      = floor_int(y);
+    bool pot        = texture->pot;
+
+    uint32_t x1     = address(xi, level->width, texture->wrap_s, pot);
+    uint32_t x2     = address(xi + 1, level->width, texture->wrap_s, pot);
+    uint32_t y1     = address(yi, level->height, texture->wrap_t, pot);
+    uint32_t y2     = address(yi + 1, level->height, texture->wrap_t, pot);
+
+    return blend_bilinear(texture, level, x1, y1, x2, y2, x - (float)xi, y - (float)yi);
+}
+
+static inline void level_request(texture_t* texture, float lod)
+{
+    // the finest level wins, only a lower value is ever written
+    uint32_t level      = (uint32_t)lod;
+    uint32_t requested  = atomic_load_explicit(&texture->requested, memory_order_relaxed);
+
+    while (level < requested &&
+           !atomic_compare_exchange_weak_explicit(&texture->requested, &requested, level,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+static vec4_t sample_trilinear(const texture_t* texture, float u, float v, float lod)
+{
+    // streamed out levels fall back to the finest resident one
+    lod             = f_max(lod, (float)texture->resident);
+
+    uint32_t l0     = (uint32_t)lod;
+    uint32_t l1     = u_min(l0 + 1, texture->levels - 1);
+    float t         = lod - (float)l0;
+
+    vec4_t result   = sample_bilinear(texture, &texture->mips[l0], u, v);
+
+    if (t > 0.f && l1 != l0)
+    {
+        vec4_t next = sample_bilinear(texture, &texture->mips[l1], u, v);
+        result      = vec4_add(vec4_scale(result, 1.f - t), vec4_scale(next, t));
+    }
+
+    return result;
+}
+
+static vec2_t atlas_coord(const texture_t* texture, float u, float v)
+{
+    // wrapped inside the packed texture, then moved into its rectangle of the page
+    const texture_t* atlas  = texture->atlas;
+
+    return vec2_new(((float)texture->atlas_x + wrap_coord(u, texture->wrap_s) * (float)texture->width) / (float)atlas->width,
+                    ((float)texture->atlas_y + wrap_coord(v, texture->wrap_t) * (float)texture->height) / (float)atlas->height);
+}
+
+static vec4_t sample_probe(const texture_t* texture, float u, float v, float lod)
+{
+    // probes of packed textures are wrapped one by one, spread in page space they would walk into the neighbours
+    if (texture->atlas)
+    {
+        vec2_t uv = atlas_coord(texture, u, v);
+
+        return sample_trilinear(texture->atlas, uv.x, uv.y, lod);
+    }
+
+    return sample_trilinear(texture, u, v, lod);
+}
+
+static vec4_t sample_anisotropic(texture_t* texture, float u, float v, vec2_t duv_dx, vec2_t duv_dy)
+{
+    // the footprint is approximated by its longer axis, probes are spread along it and the level is picked
+    // from the spacing between them instead of the full length
+    vec2_t size     = vec2_new((float)texture->width, (float)texture->height);
+    float len_x     = vec2_magnitude_sq(vec2_hadamard(duv_dx, size));
+    float len_y     = vec2_magnitude_sq(vec2_hadamard(duv_dy, size));
+    vec2_t axis     = len_x > len_y ? duv_dx : duv_dy;
+    float major     = sqrtf(f_max(len_x, len_y));
+    float minor     = sqrtf(f_min(len_x, len_y));
+
+    // probe count follows the anisotropy so isotropic footprints cost a single trilinear sample
+    uint32_t max    = get_max_anisotropy();
+    float ratio     = minor > 0.f ? major / minor : (float)max;
+    uint32_t probes = u_min((uint32_t)ceilf(ratio - 0.01f), max);
+    probes          = probes < 1 ? 1 : probes;
+
+    float rho       = major / (float)probes;
+    float lod       = rho <= 1.f ? 0.f : f_min(log2f(rho), (float)(texture->levels - 1));
+
+    level_request(texture, lod);
+
+    if (probes == 1)
+    {
+        return sample_probe(texture, u, v, lod);
+    }
+
+    vec4_t result   = vec4_new(0.f, 0.f, 0.f);
+    float step      = 1.f / (float)probes;
+
+    for (uint32_t i = 0; i < probes; i++)
+    {
+        float t     = ((float)i + 0.5f) * step - 0.5f;
+        result      = vec4_add(result, sample_probe(texture, u + axis.x * t, v + axis.y * t, lod));
+    }
+
+    return vec4_scale(result, step);
+}
+
+static texture_level_t level_downsample(const texture_t* texture, const texture_level_t* src)
 {
-    float w             = (float)texture->width;
     uint32_t stride     = texture->stride;
-    unsigned char* data = texture->data;
+    texture_level_t dst;
+    dst.width           = u_max(src->width / 2, 1);
+    dst.height          = u_max(src->height / 2, 1);
+    dst.data            = malloc(level_size(&dst, texture->layout) * stride);
+
+    for (uint32_t y = 0; y < dst.height; y++)
+    {
+        // odd sizes fold the last row/column into the previous texel
+        uint32_t y0     = u_min(y * 2, src->height - 1);
+        uint32_t y1     = u_min(y * 2 + 1, src->height - 1);
 
-    uint32_t index      = (x + (uint32_t)w * y) * stride;
-    float d             = 1.f / 255.f;
-    float b             = (float)(data[index + 2] & 0xFF);
-    float g             = (float)(data[index + 1] & 0xFF);
-    float r             = (float)(data[index + 0] & 0xFF);
+        for (uint32_t x = 0; x < dst.width; x++)
+        {
+            uint32_t x0 = u_min(x * 2, src->width - 1);
+            uint32_t x1 = u_min(x * 2 + 1, src->width - 1);
 
-    return vec4_new(b * d, g * d, r * d);
+            const unsigned char* t00 = &src->data[texture_texel_index(texture, src, x0, y0) * stride];
+            const unsigned char* t01 = &src->data[texture_texel_index(texture, src, x1, y0) * stride];
+            const unsigned char* t10 = &src->data[texture_texel_index(texture, src, x0, y1) * stride];
+            const unsigned char* t11 = &src->data[texture_texel_index(texture, src, x1, y1) * stride];
+            unsigned char* out       = &dst.data[texture_texel_index(texture, &dst, x, y) * stride];
+
+            if (texture->format == TEXTURE_FORMAT_RGB16_LINEAR)
+            {
+                const uint16_t* s00 = (const uint16_t*)t00;
+                const uint16_t* s01 = (const uint16_t*)t01;
+                const uint16_t* s10 = (const uint16_t*)t10;
+                const uint16_t* s11 = (const uint16_t*)t11;
+
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    ((uint16_t*)out)[c] = (uint16_t)(((uint32_t)s00[c] + s01[c] + s10[c] + s11[c] + 2) / 4);
+                }
+            }
+            else if (texture->format == TEXTURE_FORMAT_XYZ8_SNORM)
+            {
+                const signed char* s00 = (const signed char*)t00;
+                const signed char* s01 = (const signed char*)t01;
+                const signed char* s10 = (const signed char*)t10;
+                const signed char* s11 = (const signed char*)t11;
+
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    out[c] = (unsigned char)(signed char)f_round((float)(s00[c] + s01[c] + s10[c] + s11[c]) * 0.25f);
+                }
+            }
+            else
+            {
+                for (uint32_t c = 0; c < stride; c++)
+                {
+                    out[c] = (unsigned char)((t00[c] + t01[c] + t10[c] + t11[c] + 2) / 4);
+                }
+            }
+        }
+    }
+
+    return dst;
 }
 
 /********************/
 /* public functions */
 /********************/
 
-texture_t* texture_new(uint32_t width, uint32_t height, uint32_t stride)
+texture_t* texture_new(uint32_t width, uint32_t height, uint32_t stride, texture_layout_e layout)
 {
 	texture_t* texture = malloc(sizeof(texture_t));
 	texture->width = width;
 	texture->height = height;
 	texture->stride = stride;
-	texture->data = malloc(width * height * stride);
+	texture->layout = layout;
+	texture->format = TEXTURE_FORMAT_RGB8;
+	texture->wrap_s = TEXTURE_WRAP_REPEAT;
+	texture->wrap_t = TEXTURE_WRAP_REPEAT;
+	texture->pot = (width & (width - 1)) == 0 && (height & (height - 1)) == 0;
+	texture->compressed = false;
+	texture->levels = 1;
+	texture->resident = 0;
+	atomic_init(&texture->requested, TEXTURE_NO_REQUEST);
+	texture->atlas = NULL;
+	texture->atlas_x = 0;
+	texture->atlas_y = 0;
+	texture->mips[0] = (texture_level_t){ width, height, NULL };
+	texture->data = malloc(level_size(&texture->mips[0], layout) * stride);
+	texture->mips[0].data = texture->data;
 	return texture;
 }
 
-vec4_t texture_sample(texture_t* texture, float u, float v)
+texture_t* texture_new_atlas(uint32_t size, texture_format_e format, uint32_t stride, uint32_t levels)
 {
-    // this function converts rgba from image to bgra
+    // tiled and clamped, packed textures never address outside their gutters
+    assert((size & (size - 1)) == 0 && levels > 0 && size >> (levels - 1) >= TEXTURE_TILE_SIZE);
 
-    float w                 = (float)texture->width;
-    float h                 = (float)texture->height;
-    vec4_t result           = vec4_new(1.f, 0.f, 1.f);
+    texture_t* atlas            = texture_new(size, size, stride, TEXTURE_LAYOUT_TILED);
+    atlas->format               = format;
+    atlas->wrap_s               = TEXTURE_WRAP_CLAMP;
+    atlas->wrap_t               = TEXTURE_WRAP_CLAMP;
+    atlas->levels               = levels;
+    memset(atlas->data, 0, size * size * stride);
+
+    for (uint32_t l = 1; l < levels; l++)
+    {
+        uint32_t width          = size >> l;
+        atlas->mips[l]          = (texture_level_t){ width, width, calloc(width * width, stride) };
+    }
+
+    return atlas;
+}
+
+texture_t* texture_copy(const texture_t* texture)
+{
+    assert(!texture->atlas);
+
+    texture_t* copy             = malloc(sizeof(texture_t));
+    *copy                       = *texture;
+    atomic_init(&copy->requested, TEXTURE_NO_REQUEST);
+
+    for (uint32_t i = texture->resident; i < texture->levels; i++)
+    {
+        const texture_level_t* level = &texture->mips[i];
+        uint32_t size           = texture->compressed ? level_blocks(level) : level_size(level, texture->layout);
+
+        copy->mips[i].data      = malloc(size * texture->stride);
+        memcpy(copy->mips[i].data, level->data, size * texture->stride);
+    }
+
+    copy->data                  = copy->mips[0].data;
+
+    return copy;
+}
+
+void texture_set_layout(texture_t* texture, texture_layout_e layout)
+{
+    assert(!texture->compressed && texture->resident == 0);
+
+    if (texture->layout == layout)
+    {
+        return;
+    }
+
+    uint32_t stride             = texture->stride;
+    texture_t from              = *texture;
+
+    for (uint32_t i = 0; i < texture->levels; i++)
+    {
+        texture_level_t* level  = &texture->mips[i];
+        texture_level_t src     = *level;
+
+        // padding texels of partial tiles stay uninitialized, they are never addressed
+        texture->layout         = layout;
+        level->data             = malloc(level_size(level, layout) * stride);
+
+        for (uint32_t y = 0; y < level->height; y++)
+        {
+            for (uint32_t x = 0; x < level->width; x++)
+            {
+                const unsigned char* in = &src.data[texture_texel_index(&from, &src, x, y) * stride];
+                unsigned char* out      = &level->data[texture_texel_index(texture, level, x, y) * stride];
+
+                for (uint32_t c = 0; c < stride; c++)
+                {
+                    out[c] = in[c];
+                }
+            }
+        }
+
+        free(src.data);
+    }
+
+    texture->data = texture->mips[0].data;
+}
+
+void texture_set_format(texture_t* texture, texture_format_e format)
+{
+    // converts from the decoded bytes once at load so sampling does not have to
+    assert(texture->format == TEXTURE_FORMAT_RGB8 && !texture->compressed && texture->resident == 0);
+
+    if (format == TEXTURE_FORMAT_RGB8)
+    {
+        return;
+    }
+
+    static const uint32_t strides[] = { 0, 6, 2, 1, 3 };
+    uint16_t linear[256];
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        linear[i] = (uint16_t)f_round(f_pow((float)i / 255.f, SRGB_GAMMA) * 65535.f);
+    }
+
+    uint32_t src_stride         = texture->stride;
+    uint32_t dst_stride         = strides[format];
+
+    for (uint32_t i = 0; i < texture->levels; i++)
+    {
+        texture_level_t* level  = &texture->mips[i];
+        uint32_t size           = level_size(level, texture->layout);
+        unsigned char* data     = malloc(size * dst_stride);
+
+        // the layout is unchanged so texels keep their index, padding texels are converted along
+        for (uint32_t j = 0; j < size; j++)
+        {
+            texel_convert(format, &level->data[j * src_stride], &data[j * dst_stride], linear);
+        }
+
+        free(level->data);
+        level->data             = data;
+    }
+
+    texture->format             = format;
+    texture->stride             = dst_stride;
+    texture->data               = texture->mips[0].data;
+}
+
+void texture_compress(texture_t* texture)
+{
+    assert(!texture->compressed && texture->resident == 0);
+
+    call_once(&srgb_once, srgb_init);
+
+    // albedo is encoded in sRGB, its 8 bit steps are spread evenly over what the eye can tell apart
+    unsigned char* to_srgb          = NULL;
+
+    if (texture->format == TEXTURE_FORMAT_RGB16_LINEAR)
+    {
+        to_srgb                     = malloc(65536);
+
+        for (uint32_t i = 0; i < 65536; i++)
+        {
+            to_srgb[i]              = (unsigned char)f_round(f_pow((float)i / 65535.f, 1.f / SRGB_GAMMA) * 255.f);
+        }
+    }
+
+    uint32_t bytes                  = block_bytes(texture->format);
+
+    for (uint32_t l = 0; l < texture->levels; l++)
+    {
+        texture_level_t* level      = &texture->mips[l];
+        uint32_t blocks_x           = (level->width + BC_BLOCK_SIZE - 1) / BC_BLOCK_SIZE;
+        unsigned char* blocks       = malloc(level_blocks(level) * bytes);
+
+        for (uint32_t b = 0; b < level_blocks(level); b++)
+        {
+            unsigned char rgb[BC_BLOCK_TEXELS * 3];
+            unsigned char rg[BC_BLOCK_TEXELS * 2];
+            unsigned char values[BC_BLOCK_TEXELS];
+
+            for (uint32_t i = 0; i < BC_BLOCK_TEXELS; i++)
+            {
+                // partial blocks repeat the edge texels
+                uint32_t x          = u_min((b % blocks_x) * BC_BLOCK_SIZE + i % BC_BLOCK_SIZE, level->width - 1);
+                uint32_t y          = u_min((b / blocks_x) * BC_BLOCK_SIZE + i / BC_BLOCK_SIZE, level->height - 1);
+                const unsigned char* texel = &level->data[texture_texel_index(texture, level, x, y) * texture->stride];
+
+                switch (texture->format)
+                {
+                    case TEXTURE_FORMAT_RGB16_LINEAR:
+                    {
+                        uint16_t bgr[3];
+                        memcpy(bgr, texel, 6);
+                        rgb[i * 3 + 0] = to_srgb[bgr[2]];
+                        rgb[i * 3 + 1] = to_srgb[bgr[1]];
+                        rgb[i * 3 + 2] = to_srgb[bgr[0]];
+                        break;
+                    }
+                    case TEXTURE_FORMAT_RG8:
+                        rg[i * 2 + 0] = texel[0];
+                        rg[i * 2 + 1] = texel[1];
+                        break;
+                    case TEXTURE_FORMAT_XYZ8_SNORM:
+                        rg[i * 2 + 0] = (unsigned char)((signed char)texel[0] + 128);
+                        rg[i * 2 + 1] = (unsigned char)((signed char)texel[1] + 128);
+                        break;
+                    case TEXTURE_FORMAT_R8:
+                        values[i]      = texel[0];
+                        break;
+                    default:
+                        rgb[i * 3 + 0] = texel[0];
+                        rgb[i * 3 + 1] = texel[1];
+                        rgb[i * 3 + 2] = texel[2];
+                        break;
+                }
+            }
+
+            if (bytes == BC5_BLOCK_BYTES)
+            {
+                bc5_encode(rg, &blocks[b * bytes]);
+            }
+            else if (texture->format == TEXTURE_FORMAT_R8)
+            {
+                bc4_encode(values, &blocks[b * bytes]);
+            }
+            else
+            {
+                bc1_encode(rgb, &blocks[b * bytes]);
+            }
+        }
+
+        free(level->data);
+        level->data                 = blocks;
+    }
+
+    free(to_srgb);
+
+    texture->compressed             = true;
+    texture->stride                 = bytes;
+    texture->data                   = texture->mips[0].data;
+}
+
+uint32_t texture_memory_size(const texture_t* texture)
+{
+    uint32_t size = 0;
+
+    // texels of packed textures are counted by their page
+    if (texture->atlas)
+    {
+        return 0;
+    }
+
+    for (uint32_t i = texture->resident; i < texture->levels; i++)
+    {
+        const texture_level_t* level = &texture->mips[i];
+        size += texture->compressed ? level_blocks(level) * texture->stride : level_size(level, texture->layout) * texture->stride;
+    }
+
+    return size;
+}
+
+void texture_pack(texture_t* texture, texture_t* atlas, uint32_t x, uint32_t y, uint32_t gutter)
+{
+    // the page has the texture's format and fewer levels, origin and gutter stay whole texels on every page level
+    assert(!texture->atlas && !texture->compressed && texture->resident == 0);
+    assert(atlas->format == texture->format && atlas->stride == texture->stride && atlas->levels <= texture->levels);
+    assert(((x | y | gutter) & ((1u << (atlas->levels - 1)) - 1)) == 0 && gutter >> (atlas->levels - 1) > 0);
+
+    uint32_t stride             = texture->stride;
+
+    for (uint32_t l = 0; l < atlas->levels; l++)
+    {
+        const texture_level_t* src  = &texture->mips[l];
+        const texture_level_t* dst  = &atlas->mips[l];
+        int32_t g                   = (int32_t)(gutter >> l);
+
+        for (int32_t j = -g; j < (int32_t)src->height + g; j++)
+        {
+            uint32_t sy             = address(j, src->height, texture->wrap_t, texture->pot);
+            uint32_t dy             = (uint32_t)((int32_t)(y >> l) + j);
+
+            for (int32_t i = -g; i < (int32_t)src->width + g; i++)
+            {
+                uint32_t sx         = address(i, src->width, texture->wrap_s, texture->pot);
+                uint32_t dx         = (uint32_t)((int32_t)(x >> l) + i);
+
+                memcpy(&dst->data[texture_texel_index(atlas, dst, dx, dy) * stride],
+                       &src->data[texture_texel_index(texture, src, sx, sy) * stride],
+                       stride);
+            }
+        }
+    }
+
+    for (uint32_t l = 1; l < texture->levels; l++)
+    {
+        free(texture->mips[l].data);
+        texture->mips[l].data   = NULL;
+    }
+
+    free(texture->data);
+    texture->mips[0].data       = NULL;
+    texture->data               = NULL;
+    texture->levels             = atlas->levels;
+    texture->atlas              = atlas;
+    texture->atlas_x            = x;
+    texture->atlas_y            = y;
+}
+
+void texture_set_wrap(texture_t* texture, texture_wrap_e wrap_s, texture_wrap_e wrap_t)
+{
+    // the gutters of a packed texture were filled with the old wrap modes
+    assert(!texture->atlas);
+
+    texture->wrap_s = wrap_s;
+    texture->wrap_t = wrap_t;
+}
+
+uint32_t texture_texel_index(const texture_t* texture, const texture_level_t* level, uint32_t x, uint32_t y)
+{
+    if (texture->layout == TEXTURE_LAYOUT_TILED)
+    {
+        // a bilinear footprint mostly stays within one tile instead of touching two rows far apart
+        uint32_t mask       = TEXTURE_TILE_SIZE - 1;
+        uint32_t tiles_x    = (level->width + mask) >> TEXTURE_TILE_SHIFT;
+        uint32_t tile       = (y >> TEXTURE_TILE_SHIFT) * tiles_x + (x >> TEXTURE_TILE_SHIFT);
+
+        return (tile << (2 * TEXTURE_TILE_SHIFT)) + ((y & mask) << TEXTURE_TILE_SHIFT) + (x & mask);
+    }
+
+    return y * level->width + x;
+}
+
+void texture_generate_mips(texture_t* texture)
+{
+    assert(!texture->compressed && texture->resident == 0);
+
+    // box filtered chain down to 1x1
+    while (texture->levels < TEXTURE_MAX_LEVELS)
+    {
+        const texture_level_t* prev = &texture->mips[texture->levels - 1];
+
+        if (prev->width == 1 && prev->height == 1)
+        {
+            break;
+        }
+
+        texture->mips[texture->levels] = level_downsample(texture, prev);
+        texture->levels++;
+    }
+}
+
+void texture_evict_level(texture_t* texture)
+{
+    // the coarsest level always stays
+    assert(texture->resident + 1 < texture->levels);
+
+    free(texture->mips[texture->resident].data);
+    texture->mips[texture->resident].data = NULL;
+    texture->data = texture->mips[0].data;
+    texture->resident++;
+
+    // cached blocks may point into the freed level
+    atomic_fetch_add(&block_epoch, 1);
+}
+
+void texture_install_levels(texture_t* texture, texture_t* source, uint32_t level)
+{
+    // source holds the same image converted the same way, its levels move over without a copy
+    assert(source->levels == texture->levels && source->format == texture->format);
+    assert(source->compressed == texture->compressed && source->layout == texture->layout);
+
+    for (uint32_t i = level; i < texture->resident; i++)
+    {
+        texture->mips[i].data   = source->mips[i].data;
+        source->mips[i].data    = NULL;
+    }
+
+    texture->resident           = u_min(level, texture->resident);
+    texture->data               = texture->mips[0].data;
+    source->data                = source->mips[0].data;
+}
+
+float texture_lod(const texture_t* texture, vec2_t duv_dx, vec2_t duv_dy)
+{
+    // footprint of the pixel in texels of the base level
+    vec2_t size     = vec2_new((float)texture->width, (float)texture->height);
+    float rho_sq    = f_max(vec2_magnitude_sq(vec2_hadamard(duv_dx, size)),
+                            vec2_magnitude_sq(vec2_hadamard(duv_dy, size)));
+
+    if (rho_sq <= 1.f)
+    {
+        return 0.f;
+    }
+
+    // log2(sqrt(rho_sq))
+    return f_min(0.5f * log2f(rho_sq), (float)(texture->levels - 1));
+}
+
+vec4_t texture_sample(texture_t* texture, float u, float v, vec2_t duv_dx, vec2_t duv_dy)
+{
     texture_filter_e filter = get_texture_filter();
 
+    // anisotropic probes are placed in the packed texture's own uv space, see sample_probe
+    if (texture->atlas && filter != ANISOTROPIC_SAMPLE)
+    {
+        // the page is sampled with the footprint scaled to its size, so texel footprints and the lod stay the same
+        texture_t* atlas    = texture->atlas;
+        vec2_t scale        = vec2_new((float)texture->width / (float)atlas->width,
+                                       (float)texture->height / (float)atlas->height);
+        vec2_t uv           = atlas_coord(texture, u, v);
+
+        return texture_sample(atlas, uv.x, uv.y, vec2_hadamard(duv_dx, scale), vec2_hadamard(duv_dy, scale));
+    }
+
+    vec4_t result           = vec4_new(1.f, 0.f, 1.f);
+    const texture_level_t* base = &texture->mips[texture->resident];
+
     if (filter == POINT_SAMPLE)
     {
-        uint32_t x = (uint32_t)f_floor(u * w);
-        uint32_t y = (uint32_t)f_floor(v * h);
-        result = sample(texture, x, y);
+        level_request(texture, 0.f);
+
+        uint32_t x = address(floor_int(u * (float)base->width), base->width, texture->wrap_s, texture->pot);
+        uint32_t y = address(floor_int(v * (float)base->height), base->height, texture->wrap_t, texture->pot);
+        result = sample(texture, base, x, y);
     }
     else if (filter == BILINEAR_SAMPLE)
     {
-        float x = u * w;
-        float y = v * h;
-        float x1 = f_floor(u * w);
-        float x2 = x1 + 1.f;
-        float y1 = f_floor(v * h);
-        float y2 = y1 + 1.f;
+        level_request(texture, 0.f);
 
-        vec4_t f_x1y1 = sample(texture, (uint32_t)x1, (uint32_t)y1);
-        vec4_t f_x1y2 = sample(texture, (uint32_t)x1, (uint32_t)y2);
-        vec4_t f_x2y1 = sample(texture, (uint32_t)x2, (uint32_t)y1);
-        vec4_t f_x2y2 = sample(texture, (uint32_t)x2, (uint32_t)y2);
-
-        vec4_t f_xy1_1  = vec4_scale(f_x1y1, (x2 - x) / (x2 - x1));
-        vec4_t f_xy1_2  = vec4_scale(f_x2y1, (x - x1) / (x2 - x1));
-        vec4_t f_xy1    = vec4_add(f_xy1_1, f_xy1_2);
-
-        vec4_t f_xy2_1  = vec4_scale(f_x1y2, (x2 - x) / (x2 - x1));
-        vec4_t f_xy2_2  = vec4_scale(f_x2y2, (x - x1) / (x2 - x1));
-        vec4_t f_xy2    = vec4_add(f_xy2_1, f_xy2_2);
+        result = sample_bilinear(texture, base, u, v);
+    }
+    else if (filter == TRILINEAR_SAMPLE)
+    {
+        float lod = texture_lod(texture, duv_dx, duv_dy);
 
-        vec4_t f_xy_1   = vec4_scale(f_xy1, (y2 - y) / (y2 - y1) );
-        vec4_t f_xy_2   = vec4_scale(f_xy2, (y - y1) / (y2 - y1) );
+        level_request(texture, lod);
 
-        result = vec4_add(f_xy_1, f_xy_2);
+        result = sample_trilinear(texture, u, v, lod);
+    }
+    else if (filter == ANISOTROPIC_SAMPLE)
+    {
+        result = sample_anisotropic(texture, u, v, duv_dx, duv_dy);
     }
 
     return result;
@@ -99,6 +1159,13 @@ vec4_t texture_sample(texture_t* texture, float u, float v)
 
 void texture_free(texture_t* texture)
 {
+	for (uint32_t i = 1; i < texture->levels; i++)
+	{
+		free(texture->mips[i].data);
+	}
 	free(texture->data);
 	free(texture);
-}
\ No newline at end of file
+
+	// cached blocks may point into the freed levels
+	atomic_fetch_add(&block_epoch, 1);
+}
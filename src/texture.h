@@ -1,17 +1,79 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "math.h"
+#include "atomic_types.h"
+
+#define TEXTURE_MAX_LEVELS 16
+#define TEXTURE_TILE_SHIFT 2 /* 4x4 texel tiles, 3 for 8x8 */
+#define TEXTURE_TILE_SIZE  (1 << TEXTURE_TILE_SHIFT)
+#define TEXTURE_NO_REQUEST UINT32_MAX
+
+typedef enum
+{
+	TEXTURE_LAYOUT_LINEAR = 0, /* row major */
+	TEXTURE_LAYOUT_TILED       /* row major tiles, row major texels inside a tile */
+} texture_layout_e;
+
+typedef enum
+{
+	TEXTURE_FORMAT_RGB8 = 0,        /* R G B (A) bytes as decoded, stride 3 or 4 */
+	TEXTURE_FORMAT_RGB16_LINEAR,    /* albedo, sRGB decoded to linear 16 bit B G R */
+	TEXTURE_FORMAT_RG8,             /* metal (blue) and rough (green) */
+	TEXTURE_FORMAT_R8,              /* occlusion (red) */
+	TEXTURE_FORMAT_XYZ8_SNORM       /* normals unpacked to signed 8 bit x y z */
+} texture_format_e;
+
+typedef enum
+{
+	TEXTURE_WRAP_REPEAT = 0,
+	TEXTURE_WRAP_CLAMP,             /* clamp to edge */
+	TEXTURE_WRAP_MIRROR             /* mirrored repeat */
+} texture_wrap_e;
 
 typedef struct
 {
 	uint32_t width;
 	uint32_t height;
-	uint32_t stride;
-	unsigned char* data; /* R G B (A) */
+	unsigned char* data;
+} texture_level_t;
+
+typedef struct texture
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride; /* bytes per texel, bytes per 4x4 block when compressed */
+	texture_layout_e layout;
+	texture_format_e format;
+	texture_wrap_e wrap_s;
+	texture_wrap_e wrap_t;
+	bool pot; /* both sizes are powers of two, so are all mip levels */
+	bool compressed; /* levels hold BC1/BC4/BC5 blocks picked by format */
+	unsigned char* data; /* texels of mips[0], see texture_format_e */
+	uint32_t levels;
+	uint32_t resident; /* finest level with data, finer levels are streamed out, see texture_stream.h */
+	atomic_uint32_t requested; /* finest level sampled since the last streaming update */
+	struct texture* atlas; /* page holding the texels of a packed texture, see texture_atlas.h */
+	uint32_t atlas_x; /* origin of the texture in the atlas page */
+	uint32_t atlas_y;
+	texture_level_t mips[TEXTURE_MAX_LEVELS]; /* mips[0] is the base level */
 } texture_t;
 
-texture_t*  texture_new(uint32_t width, uint32_t height, uint32_t stride);
-vec4_t      texture_sample(texture_t* texture, float u, float v);
-void        texture_free(texture_t* texture);
\ No newline at end of file
+texture_t*  texture_new(uint32_t width, uint32_t height, uint32_t stride, texture_layout_e layout);
+texture_t*  texture_copy(const texture_t* texture);
+texture_t*  texture_new_atlas(uint32_t size, texture_format_e format, uint32_t stride, uint32_t levels);
+void        texture_set_layout(texture_t* texture, texture_layout_e layout);
+void        texture_set_format(texture_t* texture, texture_format_e format);
+void        texture_compress(texture_t* texture);
+uint32_t    texture_memory_size(const texture_t* texture);
+void        texture_pack(texture_t* texture, texture_t* atlas, uint32_t x, uint32_t y, uint32_t gutter);
+void        texture_set_wrap(texture_t* texture, texture_wrap_e wrap_s, texture_wrap_e wrap_t);
+uint32_t    texture_texel_index(const texture_t* texture, const texture_level_t* level, uint32_t x, uint32_t y);
+void        texture_generate_mips(texture_t* texture);
+void        texture_evict_level(texture_t* texture);
+void        texture_install_levels(texture_t* texture, texture_t* source, uint32_t level);
+float       texture_lod(const texture_t* texture, vec2_t duv_dx, vec2_t duv_dy);
+vec4_t      texture_sample(texture_t* texture, float u, float v, vec2_t duv_dx, vec2_t duv_dy);
+void        texture_free(texture_t* texture);
@@ -0,0 +1,208 @@
+#include "texture_atlas.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/********************
+ *  Notes
+ *
+ * Small textures are copied into shared pages of their format so the materials using them touch a few large
+ * allocations instead of many scattered ones. Pages are filled shelf by shelf: textures are placed left to right
+ * and a new shelf starts above the tallest texture of the current one. Space is not reused before the whole page
+ * is released, pages live across scene loads until their last texture is gone.
+ *
+ * Every texture is surrounded by ATLAS_GUTTER texels that repeat, clamp or mirror it like its own wrap mode
+ * would. Pages only keep the levels on which the gutter is at least a texel wide, minified packed textures stop at
+ * the coarsest of them. Anisotropic probes are wrapped one by one inside the texture, see sample_probe.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define MAX_PACKED_TEXTURES (MAX_ATLAS_PAGES * 32)
+#define ATLAS_ALIGN         (1u << (ATLAS_LEVELS - 1))      // origins and sizes stay whole texels on every level
+
+/********************/
+/* static variables */
+/********************/
+
+typedef struct
+{
+    texture_t*  texture;                // NULL for a free page
+    uint32_t    shelf_x;
+    uint32_t    shelf_y;
+    uint32_t    shelf_height;
+    uint32_t    textures;
+} page_t;
+
+typedef struct
+{
+    texture_t*  texture;                // NULL for a free entry
+    uint32_t    texels;                 // with gutters
+    uint32_t    bytes;                  // before packing
+} packed_t;
+
+static page_t   pages[MAX_ATLAS_PAGES];
+static packed_t packed[MAX_PACKED_TEXTURES];
+
+/********************/
+/* static functions */
+/********************/
+
+static bool page_place(page_t* page, uint32_t width, uint32_t height, uint32_t* x, uint32_t* y)
+{
+    uint32_t size   = page->texture->width;
+
+    // next shelf once the current one is full
+    if (page->shelf_x + width > size)
+    {
+        page->shelf_y       += page->shelf_height;
+        page->shelf_x        = 0;
+        page->shelf_height   = 0;
+    }
+
+    if (page->shelf_x + width > size || page->shelf_y + height > size)
+    {
+        return false;
+    }
+
+    *x                  = page->shelf_x;
+    *y                  = page->shelf_y;
+    page->shelf_x      += width;
+    page->shelf_height  = height > page->shelf_height ? height : page->shelf_height;
+
+    return true;
+}
+
+/********************/
+/* public functions */
+/********************/
+
+bool texture_atlas_add(texture_t* texture)
+{
+    if (texture->compressed || texture->atlas || texture->resident > 0 || texture->levels < ATLAS_LEVELS ||
+        texture->width > ATLAS_MAX_TEXTURE_SIZE || texture->height > ATLAS_MAX_TEXTURE_SIZE ||
+        texture->width % ATLAS_ALIGN != 0 || texture->height % ATLAS_ALIGN != 0)
+    {
+        return false;
+    }
+
+    uint32_t entry      = 0;
+
+    while (entry < MAX_PACKED_TEXTURES && packed[entry].texture)
+    {
+        entry++;
+    }
+
+    if (entry == MAX_PACKED_TEXTURES)
+    {
+        return false;
+    }
+
+    uint32_t width      = texture->width + 2 * ATLAS_GUTTER;
+    uint32_t height     = texture->height + 2 * ATLAS_GUTTER;
+    page_t* page        = NULL;
+    uint32_t x          = 0;
+    uint32_t y          = 0;
+
+    for (uint32_t i = 0; i < MAX_ATLAS_PAGES && !page; i++)
+    {
+        const texture_t* atlas = pages[i].texture;
+
+        if (atlas && atlas->format == texture->format && atlas->stride == texture->stride &&
+            page_place(&pages[i], width, height, &x, &y))
+        {
+            page        = &pages[i];
+        }
+    }
+
+    for (uint32_t i = 0; i < MAX_ATLAS_PAGES && !page; i++)
+    {
+        if (!pages[i].texture)
+        {
+            page        = &pages[i];
+            *page       = (page_t){ 0 };
+            page->texture = texture_new_atlas(ATLAS_PAGE_SIZE, texture->format, texture->stride, ATLAS_LEVELS);
+
+            bool placed = page_place(page, width, height, &x, &y);
+            assert(placed);
+        }
+    }
+
+    if (!page)
+    {
+        return false;
+    }
+
+    packed[entry]       = (packed_t){ .texture  = texture,
+                                      .texels   = width * height,
+                                      .bytes    = texture_memory_size(texture) };
+    page->textures++;
+
+    texture_pack(texture, page->texture, x + ATLAS_GUTTER, y + ATLAS_GUTTER, ATLAS_GUTTER);
+
+    return true;
+}
+
+void texture_atlas_remove(texture_t* texture)
+{
+    if (!texture->atlas)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < MAX_PACKED_TEXTURES; i++)
+    {
+        if (packed[i].texture == texture)
+        {
+            packed[i]   = (packed_t){ 0 };
+        }
+    }
+
+    for (uint32_t i = 0; i < MAX_ATLAS_PAGES; i++)
+    {
+        page_t* page    = &pages[i];
+
+        if (page->texture != texture->atlas)
+        {
+            continue;
+        }
+
+        // the page goes with its last texture
+        if (--page->textures == 0)
+        {
+            texture_free(page->texture);
+            *page       = (page_t){ 0 };
+        }
+    }
+
+    texture->atlas      = NULL;
+}
+
+texture_atlas_stats_t texture_atlas_stats()
+{
+    texture_atlas_stats_t stats = { 0 };
+
+    for (uint32_t i = 0; i < MAX_PACKED_TEXTURES; i++)
+    {
+        if (packed[i].texture)
+        {
+            stats.textures++;
+            stats.used_texels  += packed[i].texels;
+            stats.bytes_saved  += packed[i].bytes;
+        }
+    }
+
+    for (uint32_t i = 0; i < MAX_ATLAS_PAGES; i++)
+    {
+        if (pages[i].texture)
+        {
+            stats.pages++;
+            stats.page_texels  += pages[i].texture->width * pages[i].texture->height;
+            stats.bytes_saved  -= texture_memory_size(pages[i].texture);
+        }
+    }
+
+    return stats;
+}
\ No newline at end of file
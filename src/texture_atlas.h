@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "texture.h"
+
+#define MAX_ATLAS_PAGES         16
+#define ATLAS_PAGE_SIZE         512
+#define ATLAS_MAX_TEXTURE_SIZE  128     // larger textures keep their own allocation
+#define ATLAS_GUTTER            4       // texels around every packed texture on level 0
+#define ATLAS_LEVELS            3       // the gutter is still one texel wide on the last level
+
+typedef struct
+{
+    uint32_t textures;
+    uint32_t pages;
+    uint32_t used_texels;               // packed textures and their gutters, level 0
+    uint32_t page_texels;
+    int64_t  bytes_saved;               // unpacked textures minus pages, negative while pages are mostly empty
+} texture_atlas_stats_t;
+
+bool                    texture_atlas_add(texture_t* texture);
+void                    texture_atlas_remove(texture_t* texture);
+texture_atlas_stats_t   texture_atlas_stats();
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "texture_manager.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "texture_atlas.h"
+#include "texture_stream.h"
+
+/********************
+ *  Notes
+ *
+ * Textures are shared between materials by the hash of their encoded image, the format they were converted
+ * to and their wrap modes, so an image is decoded once per role and sampler no matter how many materials point
+ * to it. Wrap modes are part of the key because atlas gutters are filled from them. Every owner holds one
+ * reference, find hands out a new one and release frees the texture with the last one. Scenes are loaded and
+ * freed on the main thread, the manager is not synchronized.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define FNV_OFFSET  0xcbf29ce484222325ull
+#define FNV_PRIME   0x100000001b3ull
+
+/********************/
+/* static variables */
+/********************/
+
+typedef struct
+{
+    uint64_t    hash;
+    texture_t*  texture;
+    uint32_t    refs;
+} entry_t;
+
+static entry_t  entries[MAX_MANAGED_TEXTURES];
+static uint32_t entries_size = 0;
+
+/********************/
+/* static functions */
+/********************/
+
+/********************/
+/* public functions */
+/********************/
+
+uint64_t texture_manager_hash(const unsigned char* data, uint32_t size)
+{
+    // FNV-1a
+    uint64_t hash = FNV_OFFSET;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+texture_t* texture_manager_find(uint64_t hash,
+                                texture_format_e format,
+                                bool compressed,
+                                texture_wrap_e wrap_s,
+                                texture_wrap_e wrap_t)
+{
+    for (uint32_t i = 0; i < entries_size; i++)
+    {
+        texture_t* texture = entries[i].texture;
+
+        if (entries[i].hash == hash &&
+            texture->format == format &&
+            texture->compressed == compressed &&
+            texture->wrap_s == wrap_s &&
+            texture->wrap_t == wrap_t)
+        {
+            entries[i].refs++;
+            return texture;
+        }
+    }
+
+    return NULL;
+}
+
+void texture_manager_add(uint64_t hash, texture_t* texture)
+{
+    assert(entries_size < MAX_MANAGED_TEXTURES);
+
+    entries[entries_size++] = (entry_t){ .hash = hash, .texture = texture, .refs = 1 };
+}
+
+void texture_manager_release(texture_t* texture)
+{
+    for (uint32_t i = 0; i < entries_size; i++)
+    {
+        if (entries[i].texture != texture)
+        {
+            continue;
+        }
+
+        if (--entries[i].refs == 0)
+        {
+            texture_atlas_remove(texture);
+            texture_stream_remove(texture);
+            texture_free(texture);
+            entries[i] = entries[--entries_size];
+        }
+
+        return;
+    }
+
+    // not managed, the caller was the only owner
+    texture_atlas_remove(texture);
+    texture_stream_remove(texture);
+    texture_free(texture);
+}
+
+uint32_t texture_manager_count()
+{
+    return entries_size;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "texture.h"
+
+#define MAX_MANAGED_TEXTURES 64
+
+uint64_t    texture_manager_hash(const unsigned char* data, uint32_t size);
+texture_t*  texture_manager_find(uint64_t hash,
+                                 texture_format_e format,
+                                 bool compressed,
+                                 texture_wrap_e wrap_s,
+                                 texture_wrap_e wrap_t);
+void        texture_manager_add(uint64_t hash, texture_t* texture);
+void        texture_manager_release(texture_t* texture);
+uint32_t    texture_manager_count();
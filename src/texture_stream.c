@@ -0,0 +1,364 @@
+#include "texture_stream.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#include "settings.h"
+#include "parsers/png.h"
+
+/********************
+ *  Notes
+ *
+ * Streamed textures keep their coarse levels, up to the resident size given when they are added, and drop the
+ * finer ones right after load. The encoded image is kept instead. Samplers record the finest level they wanted
+ * and texture_stream_update collects these once per frame on the main thread, while nothing samples, and queues
+ * the textures that miss levels for a background thread. PNG cannot decode a single level, so the thread decodes
+ * the whole image and converts it the way the loader did, the next update moves the wanted levels over.
+ *
+ * Every level remembers the last frame it was sampled. While the streamed levels take more than
+ * get_texture_budget() bytes the least recently used finest level is evicted, levels sampled in the current
+ * frame are kept even if that leaves the budget exceeded.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+/********************/
+/* static variables */
+/********************/
+
+typedef struct
+{
+    texture_t*      texture;                    // NULL for a free slot
+    unsigned char*  image;                      // encoded png
+    uint32_t        image_size;
+    uint32_t        floor;                      // levels from here on are never evicted
+    uint32_t        target;                     // finest level of the queued decode
+    bool            pending;                    // queued, decoding or waiting to be installed
+    bool            decoding;
+    texture_t*      decoded;                    // finished decode, installed by the next update
+    uint32_t        used[TEXTURE_MAX_LEVELS];   // last frame each level was sampled
+} stream_entry_t;
+
+static stream_entry_t   entries[MAX_STREAMED_TEXTURES];
+static uint32_t         entries_size    = 0;
+static uint32_t         queue[MAX_STREAMED_TEXTURES];
+static uint32_t         queue_head      = 0;
+static uint32_t         queue_size      = 0;
+static uint32_t         frame           = 0;
+static bool             quit            = false;
+
+static thrd_t           thread;
+static once_flag        lock_once       = ONCE_FLAG_INIT;
+static mtx_t            lock;
+static cnd_t            work;                   // queued decodes or quit
+static cnd_t            done;                   // a decode finished
+
+/********************/
+/* static functions */
+/********************/
+
+static void lock_init()
+{
+    int32_t success = mtx_init(&lock, mtx_plain);
+    assert(success == thrd_success);
+
+    success         = cnd_init(&work);
+    assert(success == thrd_success);
+
+    success         = cnd_init(&done);
+    assert(success == thrd_success);
+}
+
+static int32_t decode_textures(void* data)
+{
+    (void)data;
+
+    mtx_lock(&lock);
+
+    while (true)
+    {
+        while (!quit && queue_size == 0)
+        {
+            cnd_wait(&work, &lock);
+        }
+
+        if (quit)
+        {
+            break;
+        }
+
+        stream_entry_t* entry   = &entries[queue[queue_head]];
+        queue_head              = (queue_head + 1) % MAX_STREAMED_TEXTURES;
+        queue_size--;
+        entry->decoding         = true;
+
+        // format, compression and layout of a streamed texture never change, png decoding keeps its state per thread
+        const texture_t* texture = entry->texture;
+        mtx_unlock(&lock);
+
+        texture_t* decoded      = parse_png_texture(entry->image,
+                                                    entry->image_size,
+                                                    texture->format,
+                                                    texture->compressed,
+                                                    texture->layout);
+
+        mtx_lock(&lock);
+        entry->decoded          = decoded;
+        entry->decoding         = false;
+        cnd_broadcast(&done);
+    }
+
+    mtx_unlock(&lock);
+
+    return thrd_success;
+}
+
+static void install(stream_entry_t* entry)
+{
+    texture_install_levels(entry->texture, entry->decoded, entry->target);
+    texture_free(entry->decoded);
+
+    entry->decoded  = NULL;
+    entry->pending  = false;
+}
+
+static void evict(uint32_t budget)
+{
+    uint32_t size   = texture_stream_memory_size();
+
+    while (size > budget)
+    {
+        stream_entry_t* lru = NULL;
+
+        for (uint32_t i = 0; i < MAX_STREAMED_TEXTURES; i++)
+        {
+            stream_entry_t* entry   = &entries[i];
+            uint32_t resident       = entry->texture ? entry->texture->resident : 0;
+
+            if (!entry->texture || resident >= entry->floor || entry->used[resident] == frame)
+            {
+                continue;
+            }
+
+            lru                     = !lru || entry->used[resident] < lru->used[lru->texture->resident] ? entry : lru;
+        }
+
+        // everything left was sampled this frame
+        if (!lru)
+        {
+            break;
+        }
+
+        uint32_t before = texture_memory_size(lru->texture);
+        texture_evict_level(lru->texture);
+        size           -= before - texture_memory_size(lru->texture);
+    }
+}
+
+/********************/
+/* public functions */
+/********************/
+
+void texture_stream_add(texture_t* texture, const unsigned char* image, uint32_t size, uint32_t resident_size)
+{
+    call_once(&lock_once, lock_init);
+
+    if (entries_size == 0)
+    {
+        quit                = false;
+        int32_t success     = thrd_create(&thread, decode_textures, NULL);
+        assert(success == thrd_success);
+    }
+
+    mtx_lock(&lock);
+
+    uint32_t slot           = 0;
+
+    while (slot < MAX_STREAMED_TEXTURES && entries[slot].texture)
+    {
+        slot++;
+    }
+
+    assert(slot < MAX_STREAMED_TEXTURES);
+
+    stream_entry_t* entry   = &entries[slot];
+    memset(entry, 0, sizeof(stream_entry_t));
+    entry->texture          = texture;
+    entry->image            = malloc(size);
+    entry->image_size       = size;
+    entry->floor            = texture->levels - 1;
+    memcpy(entry->image, image, size);
+    entries_size++;
+
+    while (entry->floor > 0 &&
+           texture->mips[entry->floor - 1].width <= resident_size &&
+           texture->mips[entry->floor - 1].height <= resident_size)
+    {
+        entry->floor--;
+    }
+
+    // finer levels are decoded again once they are sampled
+    while (texture->resident < entry->floor)
+    {
+        texture_evict_level(texture);
+    }
+
+    mtx_unlock(&lock);
+}
+
+void texture_stream_remove(texture_t* texture)
+{
+    call_once(&lock_once, lock_init);
+
+    mtx_lock(&lock);
+
+    uint32_t slot           = 0;
+
+    while (slot < MAX_STREAMED_TEXTURES && entries[slot].texture != texture)
+    {
+        slot++;
+    }
+
+    if (slot == MAX_STREAMED_TEXTURES)
+    {
+        mtx_unlock(&lock);
+        return;
+    }
+
+    stream_entry_t* entry   = &entries[slot];
+
+    while (entry->decoding)
+    {
+        cnd_wait(&done, &lock);
+    }
+
+    // drop a queued decode, the rest of the queue keeps its order
+    uint32_t kept           = 0;
+
+    for (uint32_t i = 0; i < queue_size; i++)
+    {
+        uint32_t queued     = queue[(queue_head + i) % MAX_STREAMED_TEXTURES];
+
+        if (queued != slot)
+        {
+            queue[(queue_head + kept++) % MAX_STREAMED_TEXTURES] = queued;
+        }
+    }
+
+    queue_size              = kept;
+
+    if (entry->decoded)
+    {
+        texture_free(entry->decoded);
+    }
+
+    free(entry->image);
+    memset(entry, 0, sizeof(stream_entry_t));
+    entries_size--;
+
+    // the thread only runs while there is something to stream
+    bool last               = entries_size == 0;
+    quit                    = last;
+    cnd_signal(&work);
+    mtx_unlock(&lock);
+
+    if (last)
+    {
+        int32_t success;
+        thrd_join(thread, &success);
+        assert(success == thrd_success);
+    }
+}
+
+void texture_stream_update()
+{
+    if (entries_size == 0)
+    {
+        return;
+    }
+
+    mtx_lock(&lock);
+    frame++;
+
+    for (uint32_t i = 0; i < MAX_STREAMED_TEXTURES; i++)
+    {
+        stream_entry_t* entry   = &entries[i];
+        texture_t* texture      = entry->texture;
+
+        if (!texture)
+        {
+            continue;
+        }
+
+        if (entry->decoded)
+        {
+            install(entry);
+        }
+
+        uint32_t level          = atomic_exchange_explicit(&texture->requested, TEXTURE_NO_REQUEST, memory_order_relaxed);
+
+        if (level == TEXTURE_NO_REQUEST)
+        {
+            continue;
+        }
+
+        for (uint32_t l = level; l < texture->levels; l++)
+        {
+            entry->used[l]      = frame;
+        }
+
+        if (level < texture->resident && !entry->pending)
+        {
+            entry->target       = level;
+            entry->pending      = true;
+            queue[(queue_head + queue_size++) % MAX_STREAMED_TEXTURES] = i;
+        }
+    }
+
+    cnd_signal(&work);
+    evict(get_texture_budget());
+    mtx_unlock(&lock);
+}
+
+void texture_stream_flush()
+{
+    if (entries_size == 0)
+    {
+        return;
+    }
+
+    mtx_lock(&lock);
+
+    for (uint32_t i = 0; i < MAX_STREAMED_TEXTURES; i++)
+    {
+        stream_entry_t* entry = &entries[i];
+
+        while (entry->pending && !entry->decoded)
+        {
+            cnd_wait(&done, &lock);
+        }
+
+        if (entry->decoded)
+        {
+            install(entry);
+        }
+    }
+
+    mtx_unlock(&lock);
+}
+
+uint32_t texture_stream_memory_size()
+{
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i < MAX_STREAMED_TEXTURES; i++)
+    {
+        size += entries[i].texture ? texture_memory_size(entries[i].texture) : 0;
+    }
+
+    return size;
+}
\ No newline at end of file
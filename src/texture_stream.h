@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "texture.h"
+
+#define MAX_STREAMED_TEXTURES       64
+#define TEXTURE_STREAM_RESIDENT_SIZE 64     // levels up to this many texels per side are never streamed out
+
+void        texture_stream_add(texture_t* texture, const unsigned char* image, uint32_t size, uint32_t resident_size);
+void        texture_stream_remove(texture_t* texture);
+void        texture_stream_update();
+void        texture_stream_flush();
+uint32_t    texture_stream_memory_size();
\ No newline at end of file
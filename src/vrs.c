@@ -0,0 +1,178 @@
+#include "vrs.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "math.h"
+
+/********************
+ *  Notes
+ *
+ * - D3D12 VRS          - https://microsoft.github.io/DirectX-Specs/d3d/VariableRateShading.html
+ * - Adaptive shading   - https://developer.nvidia.com/vrworks/graphics/variablerateshading
+ *
+ * The screen is split in VRS_TILE_SIZE x VRS_TILE_SIZE tiles and every tile gets a shading rate based on the
+ * colour gradient of the previous frame (largest channel difference between neighbouring pixels). Flat tiles are shaded once per 4x4 or 2x2 coarse pixel, the rest per
+ * pixel. The rasterizer still depth tests every pixel, only the call to shader_fragment is shared: the first
+ * covered pixel of a coarse pixel is shaded and the colour is cached for the remaining pixels of the same
+ * triangle. The cache is invalidated per triangle with a stamp instead of being cleared.
+ *
+ * The previous frame was shaded at the old rates and the pixels of one coarse pixel are equal, comparing them
+ * would make coarse tiles look flatter than they are and keep them coarse. Pixels are compared SAMPLE_STEP apart,
+ * or a coarse pixel apart in 4x4 tiles, so every pair holds two shaded samples. The mean difference is scaled to
+ * the gradient over SAMPLE_STEP pixels, the largest one is not, an edge is as sharp however far apart the samples
+ * are.
+ ********************/
+
+/********************/
+/*      defines     */
+/********************/
+
+#define SAMPLE_STEP         2           // every other pixel is compared with the one a coarse pixel away
+#define COARSE_4X4_MEAN     2
+#define COARSE_4X4_MAX      6
+#define COARSE_2X2_MEAN     4
+#define COARSE_2X2_MAX      16
+
+/********************/
+/* static variables */
+/********************/
+
+/********************/
+/* static functions */
+/********************/
+
+static uint32_t difference(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+// largest per channel difference, plain luminance misses edges between colours of similar brightness
+static uint32_t contrast(uint32_t c0, uint32_t c1)
+{
+    uint32_t b = difference((c0 >> 0)  & 0xFF, (c1 >> 0)  & 0xFF);
+    uint32_t g = difference((c0 >> 8)  & 0xFF, (c1 >> 8)  & 0xFF);
+    uint32_t r = difference((c0 >> 16) & 0xFF, (c1 >> 16) & 0xFF);
+
+    return u_max(b, u_max(g, r));
+}
+
+static shading_rate_e tile_rate(vrs_map_t* map, framebuffer_t* frame, uint32_t tx, uint32_t ty)
+{
+    // pairs are a shaded sample apart, never two pixels of the same coarse pixel
+    uint32_t rate   = map->rates[ty * map->tiles_x + tx];
+    uint32_t step   = u_max(rate, SAMPLE_STEP);
+    uint32_t min_x  = tx * VRS_TILE_SIZE;
+    uint32_t min_y  = ty * VRS_TILE_SIZE;
+    uint32_t max_x  = u_min(min_x + VRS_TILE_SIZE, map->width - step);
+    uint32_t max_y  = u_min(min_y + VRS_TILE_SIZE, map->height - step);
+    uint32_t sum    = 0;
+    uint32_t max    = 0;
+    uint32_t count  = 0;
+
+    for (uint32_t y = min_y; y < max_y; y += step)
+    {
+        for (uint32_t x = min_x; x < max_x; x += step)
+        {
+            uint32_t c  = framebuffer_get(frame, x, y);
+            uint32_t dx = contrast(c, framebuffer_get(frame, x + step, y));
+            uint32_t dy = contrast(c, framebuffer_get(frame, x, y + step));
+
+            sum        += dx + dy;
+            max         = u_max(max, u_max(dx, dy));
+            count      += 2;
+        }
+    }
+
+    if (count == 0)
+    {
+        return SHADING_RATE_1X1;
+    }
+
+    uint32_t mean = sum * SAMPLE_STEP / (count * step);
+
+    if (mean < COARSE_4X4_MEAN && max < COARSE_4X4_MAX)
+    {
+        return SHADING_RATE_4X4;
+    }
+
+    if (mean < COARSE_2X2_MEAN && max < COARSE_2X2_MAX)
+    {
+        return SHADING_RATE_2X2;
+    }
+
+    return SHADING_RATE_1X1;
+}
+
+/********************/
+/* public functions */
+/********************/
+
+vrs_map_t* vrs_map_new(uint32_t width, uint32_t height)
+{
+    assert(width > 0 && height > 0);
+
+    vrs_map_t* map  = malloc(sizeof(vrs_map_t));
+    map->width      = width;
+    map->height     = height;
+    map->tiles_x    = (width + VRS_TILE_SIZE - 1) / VRS_TILE_SIZE;
+    map->tiles_y    = (height + VRS_TILE_SIZE - 1) / VRS_TILE_SIZE;
+    map->rates      = malloc(map->tiles_x * map->tiles_y);
+    map->stamp      = 0;
+
+    uint32_t cells  = ((width + 1) / 2) * ((height + 1) / 2);
+    map->stamps     = calloc(cells, sizeof(uint32_t));
+    map->colors     = malloc(cells * sizeof(uint32_t));
+
+    memset(map->rates, SHADING_RATE_1X1, map->tiles_x * map->tiles_y);
+
+    return map;
+}
+
+void vrs_map_update(vrs_map_t* map, framebuffer_t* previous)
+{
+    assert(previous->width == map->width && previous->height == map->height);
+
+    for (uint32_t ty = 0; ty < map->tiles_y; ty++)
+    {
+        for (uint32_t tx = 0; tx < map->tiles_x; tx++)
+        {
+            map->rates[ty * map->tiles_x + tx] = (uint8_t)tile_rate(map, previous, tx, ty);
+        }
+    }
+}
+
+shading_rate_e vrs_map_get(const vrs_map_t* map, uint32_t x, uint32_t y)
+{
+    return (shading_rate_e)map->rates[(y / VRS_TILE_SIZE) * map->tiles_x + x / VRS_TILE_SIZE];
+}
+
+uint32_t vrs_map_next_stamp(vrs_map_t* map)
+{
+    map->stamp++;
+
+    // 0 marks an empty cell, start over when the stamp wraps around
+    if (map->stamp == 0)
+    {
+        memset(map->stamps, 0, ((map->width + 1) / 2) * ((map->height + 1) / 2) * sizeof(uint32_t));
+        map->stamp = 1;
+    }
+
+    return map->stamp;
+}
+
+uint32_t vrs_map_cell(const vrs_map_t* map, uint32_t x, uint32_t y, shading_rate_e rate)
+{
+    uint32_t mask = ~((uint32_t)rate - 1);
+
+    return ((y & mask) / 2) * ((map->width + 1) / 2) + (x & mask) / 2;
+}
+
+void vrs_map_free(vrs_map_t* map)
+{
+    free(map->rates);
+    free(map->stamps);
+    free(map->colors);
+    free(map);
+}
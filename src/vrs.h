@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+
+#define VRS_TILE_SIZE       16
+
+typedef enum
+{
+    SHADING_RATE_1X1 = 1,
+    SHADING_RATE_2X2 = 2,
+    SHADING_RATE_4X4 = 4
+} shading_rate_e;
+
+typedef struct
+{
+    uint32_t        width;
+    uint32_t        height;
+    uint32_t        tiles_x;
+    uint32_t        tiles_y;
+    uint8_t*        rates;          // shading_rate_e per tile
+
+    // coarse pixel cache, one entry per 2x2 cell (a 4x4 cell uses the entry of its first 2x2 cell)
+    uint32_t        stamp;          // incremented for every shaded triangle
+    uint32_t*       stamps;
+    uint32_t*       colors;
+
+} vrs_map_t;
+
+vrs_map_t*      vrs_map_new(uint32_t width, uint32_t height);
+void            vrs_map_update(vrs_map_t* map, framebuffer_t* previous);
+shading_rate_e  vrs_map_get(const vrs_map_t* map, uint32_t x, uint32_t y);
+uint32_t        vrs_map_next_stamp(vrs_map_t* map);
+uint32_t        vrs_map_cell(const vrs_map_t* map, uint32_t x, uint32_t y, shading_rate_e rate);
+void            vrs_map_free(vrs_map_t* map);